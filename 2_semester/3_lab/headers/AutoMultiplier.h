@@ -0,0 +1,575 @@
+#pragma once
+#include "MatrixMultiplier.h"
+#include "SequentialMultiplier.h"
+#include "ParallelMultiplier.h"
+#include "KSplitMultiplier.h"
+#include "BlockedMultiplier.h"
+#include "SimdMultiplier.h"
+#include "StrassenMultiplier.h"
+#include "FixedSizeMultiplier.h"
+#include "ThreadPool.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Strategy and parameters picked by the autotuner for one shape bucket
+ */
+struct TuningChoice
+{
+    string strategy;       // "sequential", "sequential-packed", "parallel", "parallel-packed",
+                           // "k-split", "blocked", "simd", "strassen" or "fixed-size"
+    size_t threads = 1;    // strips of the parallel strategies, 1 otherwise
+    size_t rowBlock = 0;   // block sizes of the packed and blocked strategies, 0 for the defaults
+    size_t innerBlock = 0;
+    size_t colBlock = 0;
+    double ms = 0.0;       // best time measured while tuning
+};
+
+/**
+ * @brief Multiplier that measures the other strategies and uses the fastest one per shape
+ *
+ * Shapes are grouped into buckets: every dimension up to 16 is kept exact,
+ * larger ones are rounded to the nearest power of two from 32 up. The first product of a
+ * bucket is tuned on the operands at hand:
+ *  - every applicable strategy runs with its default parameters, the
+ *    parallel ones with 2, 4, ... up to maxThreads strips,
+ *  - the winner, if it has block sizes, is then run with a few other
+ *    block shapes.
+ * Each candidate runs twice and its faster run counts. The choice is kept
+ * in a table and, if a path was given, written to a text file that later
+ * instances read on construction, so tuning is paid once per machine.
+ * Lines of the file that cannot be parsed are ignored (the bucket is
+ * simply tuned again). The instances of the chosen strategies are cached,
+ * and the parallel ones share one ThreadPool of maxThreads workers.
+ *
+ * @tparam T Element type of the input matrices
+ * @tparam R Accumulation type, also the element type of the result
+ */
+template <typename T, typename R = typename DefaultAccumulator<T>::type>
+class BasicAutoMultiplier : public BasicMatrixMultiplier<T, R>
+{
+private:
+    static constexpr size_t SMALL_VOLUME = size_t(1) << 21; // rows*inner*cols up to which unpacked loops compete
+    static constexpr int TUNING_RUNS = 2;                    // runs per candidate, the fastest counts
+
+    string tablePath;                                          // file the table is persisted to, empty for none
+    size_t maxThreads;                                         // upper bound of the thread sweep
+    shared_ptr<ThreadPool> pool;                               // workers of the parallel candidates
+    map<string, TuningChoice> table;                           // bucket key -> choice
+    map<string, unique_ptr<BasicMatrixMultiplier<T, R>>> cache; // choice description -> configured multiplier
+    BasicMatrix<R> scratch;                                    // output of the tuning runs
+    size_t tuned;                                              // buckets tuned by this instance
+    map<string, string> names;                                 // choice description -> "Auto (description)"
+    atomic<const char *> name;                                 // "Auto", or the entry of names of the last choice
+
+    /**
+     * @brief Rounds a dimension to its bucket
+     */
+    static size_t bucket(size_t n);
+
+    /**
+     * @brief Gets the identifier of the element types used in the table, e.g. "int8/int32"
+     */
+    static string typeName();
+
+    /**
+     * @brief Gets the table key of a product shape
+     */
+    static string keyOf(size_t rows, size_t inner, size_t cols);
+
+    /**
+     * @brief Gets a unique text form of a choice's strategy and parameters
+     */
+    static string describe(const TuningChoice &choice);
+
+    /**
+     * @brief Creates a multiplier configured as described by a choice
+     * @throw std::invalid_argument if the strategy does not exist for these element types
+     */
+    unique_ptr<BasicMatrixMultiplier<T, R>> create(const TuningChoice &choice) const;
+
+    /**
+     * @brief Gets the cached multiplier of a choice, creating it on first use
+     */
+    BasicMatrixMultiplier<T, R> &instance(const TuningChoice &choice);
+
+    /**
+     * @brief Lists the candidates of the first tuning stage for a shape
+     */
+    vector<TuningChoice> candidates(size_t rows, size_t inner, size_t cols) const;
+
+    /**
+     * @brief Measures a candidate on the operands, keeping its fastest run in choice.ms
+     */
+    void measure(TuningChoice &choice, const BasicMatrix<T> &a, const BasicMatrix<T> &b);
+
+    /**
+     * @brief Finds the fastest candidate for the shape of a and b
+     */
+    TuningChoice tune(const BasicMatrix<T> &a, const BasicMatrix<T> &b);
+
+    /**
+     * @brief Reads the table file if it exists
+     */
+    void load();
+
+    /**
+     * @brief Writes the whole table to the file, replacing it atomically
+     * @throw std::runtime_error if the file cannot be written
+     */
+    void save() const;
+
+protected:
+    /**
+     * @brief Multiplies with the strategy tuned for the shape, tuning it first if needed
+     * @param a First matrix
+     * @param b Second matrix
+     * @param out Receives (or accumulates) the product
+     * @param mode Overwrite out or add the product to it
+     * @param alpha Scale applied to the product
+     * @throw std::runtime_error if a newly tuned table cannot be written to its file
+     */
+    void compute(const BasicMatrix<T> &a, const BasicMatrix<T> &b, BasicMatrix<R> &out,
+                 Accumulate mode, R alpha) override;
+
+public:
+    /**
+     * @brief Construct a new Auto Multiplier object
+     * @param tablePath File persisting the tuning table, read now if it exists; empty to keep it in memory
+     * @param maxThreads Largest number of threads tried for the parallel strategies
+     * @throw std::invalid_argument if maxThreads is zero
+     */
+    explicit BasicAutoMultiplier(const string &tablePath = "", size_t maxThreads = ThreadPool::defaultSize());
+
+    /**
+     * @brief Looks up the choice for a shape without tuning
+     * @param rows Rows of A
+     * @param inner Columns of A, rows of B
+     * @param cols Columns of B
+     * @return const TuningChoice* - the choice of the shape's bucket, nullptr if it is not tuned yet
+     */
+    const TuningChoice *findChoice(size_t rows, size_t inner, size_t cols) const;
+
+    /**
+     * @brief Gets the tuning table
+     * @return const map<string, TuningChoice>& - bucket key, e.g. "double 512x512x512", to choice
+     */
+    const map<string, TuningChoice> &getTable() const { return table; }
+
+    /**
+     * @brief Gets the number of buckets this instance had to tune
+     * @return size_t - 0 if every product used a loaded choice
+     */
+    size_t getTunedCount() const { return tuned; }
+
+    /**
+     * @brief Gets the name of the multiplication algorithm
+     * The names are kept for the lifetime of the multiplier, so the pointer
+     * stays valid after later products and may be read from another thread
+     * while multiplyAsync() runs.
+     *
+     * @return const char* - "Auto", with the strategy of the last product in parentheses
+     */
+    const char *getName() const override { return name.load(); }
+};
+
+template <typename T, typename R>
+BasicAutoMultiplier<T, R>::BasicAutoMultiplier(const string &tablePath, size_t maxThreads)
+    : tablePath(tablePath), maxThreads(maxThreads), scratch(0, 0), tuned(0), name("Auto")
+{
+    if (maxThreads == 0)
+    {
+        throw std::invalid_argument("Number of threads must be positive");
+    }
+    pool = make_shared<ThreadPool>(maxThreads);
+    load();
+}
+
+template <typename T, typename R>
+size_t BasicAutoMultiplier<T, R>::bucket(size_t n)
+{
+    if (n <= 16)
+    {
+        return n;
+    }
+    // nearest power of two on a logarithmic scale, so a bucket spans the same ratio of sizes
+    size_t power = 32;
+    while (power * 2 <= n)
+    {
+        power *= 2;
+    }
+    return n * n < 2 * power * power ? power : 2 * power;
+}
+
+template <typename T, typename R>
+string BasicAutoMultiplier<T, R>::typeName()
+{
+    auto nameOf = [](auto tag) -> string
+    {
+        using U = decltype(tag);
+        if constexpr (is_same_v<U, float>)
+            return "float";
+        else if constexpr (is_same_v<U, double>)
+            return "double";
+        else
+            return "int" + to_string(sizeof(U) * 8);
+    };
+    const string input = nameOf(T());
+    const string accumulator = nameOf(R());
+    return input == accumulator ? input : input + "/" + accumulator;
+}
+
+template <typename T, typename R>
+string BasicAutoMultiplier<T, R>::keyOf(size_t rows, size_t inner, size_t cols)
+{
+    return typeName() + " " + to_string(bucket(rows)) + "x" + to_string(bucket(inner)) + "x" + to_string(bucket(cols));
+}
+
+template <typename T, typename R>
+string BasicAutoMultiplier<T, R>::describe(const TuningChoice &choice)
+{
+    string text = choice.strategy;
+    if (choice.threads > 1)
+    {
+        text += " x" + to_string(choice.threads);
+    }
+    if (choice.rowBlock != 0)
+    {
+        text += " " + to_string(choice.rowBlock) + "/" + to_string(choice.innerBlock) + "/" + to_string(choice.colBlock);
+    }
+    return text;
+}
+
+template <typename T, typename R>
+unique_ptr<BasicMatrixMultiplier<T, R>> BasicAutoMultiplier<T, R>::create(const TuningChoice &choice) const
+{
+    const bool blocks = choice.rowBlock != 0;
+    if (choice.strategy == "sequential" || choice.strategy == "sequential-packed")
+    {
+        auto multiplier = make_unique<BasicSequentialMultiplier<T, R>>(choice.strategy == "sequential-packed");
+        if (blocks)
+        {
+            multiplier->setBlockSizes(choice.rowBlock, choice.innerBlock, choice.colBlock);
+        }
+        return multiplier;
+    }
+    if (choice.strategy == "parallel" || choice.strategy == "parallel-packed")
+    {
+        auto multiplier = make_unique<BasicParallelMultiplier<T, R>>(pool, choice.threads,
+                                                                     choice.strategy == "parallel-packed");
+        if (blocks)
+        {
+            multiplier->setBlockSizes(choice.rowBlock, choice.innerBlock, choice.colBlock);
+        }
+        return multiplier;
+    }
+    if (choice.strategy == "k-split")
+    {
+        return make_unique<BasicKSplitMultiplier<T, R>>(pool, choice.threads);
+    }
+    if constexpr (is_same_v<T, R>)
+    {
+        if (choice.strategy == "fixed-size")
+        {
+            return make_unique<BasicFixedSizeMultiplier<T>>();
+        }
+    }
+    if constexpr (is_same_v<T, double> && is_same_v<R, double>)
+    {
+        if (choice.strategy == "blocked")
+        {
+            return blocks ? make_unique<BlockedMultiplier>(choice.rowBlock, choice.innerBlock, choice.colBlock)
+                          : make_unique<BlockedMultiplier>();
+        }
+        if (choice.strategy == "simd")
+        {
+            return make_unique<SimdMultiplier>();
+        }
+        if (choice.strategy == "strassen")
+        {
+            return make_unique<StrassenMultiplier>();
+        }
+    }
+    throw std::invalid_argument("Unknown strategy '" + choice.strategy + "' for these element types");
+}
+
+template <typename T, typename R>
+BasicMatrixMultiplier<T, R> &BasicAutoMultiplier<T, R>::instance(const TuningChoice &choice)
+{
+    auto &slot = cache[describe(choice)];
+    if (!slot)
+    {
+        slot = create(choice);
+    }
+    return *slot;
+}
+
+template <typename T, typename R>
+vector<TuningChoice> BasicAutoMultiplier<T, R>::candidates(size_t rows, size_t inner, size_t cols) const
+{
+    auto choice = [](const string &strategy, size_t threads = 1)
+    {
+        TuningChoice c;
+        c.strategy = strategy;
+        c.threads = threads;
+        return c;
+    };
+
+    // the plain triple loops only stand a chance on small products
+    const bool small = rows * inner * cols <= SMALL_VOLUME;
+    vector<TuningChoice> list;
+    if (small)
+    {
+        list.push_back(choice("sequential"));
+    }
+    list.push_back(choice("sequential-packed"));
+    for (size_t threads = 2; threads / 2 < maxThreads; threads *= 2)
+    {
+        const size_t t = min(threads, maxThreads);
+        if (t < 2 || t > rows)
+        {
+            break;
+        }
+        if (small)
+        {
+            list.push_back(choice("parallel", t));
+        }
+        list.push_back(choice("parallel-packed", t));
+    }
+    // splitting the shared dimension is not limited by the number of rows
+    for (size_t threads = 2; threads / 2 < maxThreads; threads *= 2)
+    {
+        const size_t t = min(threads, maxThreads);
+        if (!BasicKSplitMultiplier<T, R>::suits(rows, inner, cols, t))
+        {
+            break;
+        }
+        list.push_back(choice("k-split", t));
+    }
+
+    if constexpr (is_same_v<T, R>)
+    {
+        if (rows == inner && inner == cols && BasicFixedSizeMultiplier<T>::hasKernel(rows))
+        {
+            list.push_back(choice("fixed-size"));
+        }
+    }
+    if constexpr (is_same_v<T, double> && is_same_v<R, double>)
+    {
+        list.push_back(choice("blocked"));
+        list.push_back(choice("simd"));
+        if (min({rows, inner, cols}) > 256) // below its default cutoff Strassen is plain SIMD
+        {
+            list.push_back(choice("strassen"));
+        }
+    }
+    return list;
+}
+
+template <typename T, typename R>
+void BasicAutoMultiplier<T, R>::measure(TuningChoice &choice, const BasicMatrix<T> &a, const BasicMatrix<T> &b)
+{
+    BasicMatrixMultiplier<T, R> &multiplier = instance(choice);
+    choice.ms = numeric_limits<double>::infinity();
+    for (int run = 0; run < TUNING_RUNS; ++run)
+    {
+        this->checkCancelled(); // tuning reports no tiles, but a cancelled product stops between runs
+        auto start = chrono::steady_clock::now();
+        multiplier.multiplyInto(a, b, scratch);
+        auto end = chrono::steady_clock::now();
+        choice.ms = min(choice.ms, chrono::duration<double, milli>(end - start).count());
+    }
+}
+
+template <typename T, typename R>
+TuningChoice BasicAutoMultiplier<T, R>::tune(const BasicMatrix<T> &a, const BasicMatrix<T> &b)
+{
+    TuningChoice best;
+    best.ms = numeric_limits<double>::infinity();
+    for (TuningChoice &candidate : candidates(a.getRows(), a.getCols(), b.getCols()))
+    {
+        measure(candidate, a, b);
+        if (candidate.ms < best.ms)
+        {
+            best = candidate;
+        }
+    }
+
+    // second stage: other block shapes for the winner, if it has any
+    vector<array<size_t, 3>> shapes;
+    if (best.strategy == "sequential-packed" || best.strategy == "parallel-packed")
+    {
+        shapes = {{64, 128, 512}, {96, 384, 1024}, {256, 256, 4096}};
+    }
+    else if (best.strategy == "blocked")
+    {
+        shapes = {{32, 256, 256}, {128, 64, 1024}, {64, 256, 2048}};
+    }
+    for (const auto &shape : shapes)
+    {
+        TuningChoice candidate = best;
+        candidate.rowBlock = shape[0];
+        candidate.innerBlock = shape[1];
+        candidate.colBlock = shape[2];
+        measure(candidate, a, b);
+        if (candidate.ms < best.ms)
+        {
+            best = candidate;
+        }
+    }
+
+    // the losers are not needed any more; the winner stays cached for the next products
+    const string winner = describe(best);
+    for (auto it = cache.begin(); it != cache.end();)
+    {
+        bool chosen = it->first == winner;
+        for (const auto &entry : table)
+        {
+            chosen = chosen || it->first == describe(entry.second);
+        }
+        it = chosen ? next(it) : cache.erase(it);
+    }
+    return best;
+}
+
+template <typename T, typename R>
+void BasicAutoMultiplier<T, R>::load()
+{
+    if (tablePath.empty())
+    {
+        return;
+    }
+    ifstream file(tablePath);
+    string line;
+    while (getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        // type rowsxinnerxcols strategy threads rowBlock innerBlock colBlock ms
+        istringstream fields(line);
+        string type, shape;
+        TuningChoice choice;
+        if (!(fields >> type >> shape >> choice.strategy >> choice.threads >> choice.rowBlock >>
+              choice.innerBlock >> choice.colBlock >> choice.ms))
+        {
+            continue;
+        }
+        // entries of other element types, or for more threads than allowed here, are skipped
+        if (type != typeName() || choice.threads == 0 || choice.threads > maxThreads)
+        {
+            continue;
+        }
+        try
+        {
+            create(choice);
+        }
+        catch (const std::invalid_argument &)
+        {
+            continue;
+        }
+        table[type + " " + shape] = choice;
+    }
+}
+
+template <typename T, typename R>
+void BasicAutoMultiplier<T, R>::save() const
+{
+    if (tablePath.empty())
+    {
+        return;
+    }
+
+    // entries of other element types are kept, so one file serves all instantiations
+    vector<string> foreign;
+    {
+        ifstream existing(tablePath);
+        string line;
+        while (getline(existing, line))
+        {
+            if (!line.empty() && line[0] != '#' && line.compare(0, typeName().size() + 1, typeName() + " ") != 0)
+            {
+                foreign.push_back(line);
+            }
+        }
+    }
+
+    const string temporary = tablePath + ".tmp";
+    {
+        ofstream file(temporary, ios::trunc);
+        file << "# type shape strategy threads rowBlock innerBlock colBlock ms\n";
+        for (const string &line : foreign)
+        {
+            file << line << "\n";
+        }
+        for (const auto &[key, choice] : table)
+        {
+            file << key << " " << choice.strategy << " " << choice.threads << " " << choice.rowBlock << " "
+                 << choice.innerBlock << " " << choice.colBlock << " " << choice.ms << "\n";
+        }
+        if (!file)
+        {
+            throw std::runtime_error("Cannot write tuning table " + temporary);
+        }
+    }
+    // rename replaces the old table in one step, readers never see a partial file
+    filesystem::rename(temporary, tablePath);
+}
+
+template <typename T, typename R>
+void BasicAutoMultiplier<T, R>::compute(const BasicMatrix<T> &a, const BasicMatrix<T> &b,
+                                        BasicMatrix<R> &out, Accumulate mode, R alpha)
+{
+    this->validateOutput(a, b, out, mode);
+
+    const string key = keyOf(a.getRows(), a.getCols(), b.getCols());
+    auto found = table.find(key);
+    if (found == table.end())
+    {
+        TuningChoice best = tune(a, b);
+        found = table.emplace(key, best).first;
+        ++tuned;
+        save();
+    }
+
+    const string description = describe(found->second);
+    auto named = names.find(description);
+    if (named == names.end())
+    {
+        named = names.emplace(description, "Auto (" + description + ")").first;
+    }
+    name.store(named->second.c_str());
+    this->delegateInto(instance(found->second), a, b, out, mode, alpha);
+}
+
+template <typename T, typename R>
+const TuningChoice *BasicAutoMultiplier<T, R>::findChoice(size_t rows, size_t inner, size_t cols) const
+{
+    auto found = table.find(keyOf(rows, inner, cols));
+    return found == table.end() ? nullptr : &found->second;
+}
+
+/**
+ * @brief Auto multiplier of double matrices
+ */
+using AutoMultiplier = BasicAutoMultiplier<double>;
+
+template class BasicAutoMultiplier<float>;
+template class BasicAutoMultiplier<double>;
+template class BasicAutoMultiplier<int32_t>;
+template class BasicAutoMultiplier<int64_t>;
+template class BasicAutoMultiplier<int8_t, int32_t>;
+template class BasicAutoMultiplier<int16_t, int32_t>;
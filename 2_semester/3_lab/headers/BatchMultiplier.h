@@ -0,0 +1,280 @@
+#pragma once
+#include "MatrixMultiplier.h"
+#include "SimdMultiplier.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if __has_include(<span>)
+#include <span>
+#endif
+
+/**
+ * @brief Multiplication of many small matrices of one shape in a single call
+ *
+ * For tiny products (4x4 up to about 64x64) the work per product is so
+ * small that the fixed costs of MatrixMultiplier::multiply() dominate:
+ * a virtual call, validation, a heap allocation for the result and, for the
+ * parallel strategies, scheduling inside a product that is too small to
+ * split. multiplyBatch() pays these costs once per batch instead:
+ *  - the shapes are checked once for the whole batch (all A's share one
+ *    shape and all B's another),
+ *  - results that do not already have the right shape are allocated
+ *    together in one contiguous arena (see BasicMatrix::makeBatch()), and
+ *    outputs reused across calls are written in place without allocating,
+ *  - the batch is split into contiguous chunks of products, one per thread,
+ *    and every product runs sequentially inside its chunk. Batches with
+ *    too little work to amortize a task run on the calling thread.
+ *
+ * @tparam T Element type of the input matrices
+ * @tparam R Accumulation type, also the element type of the results
+ */
+template <typename T, typename R = typename DefaultAccumulator<T>::type>
+class BasicBatchMultiplier
+{
+private:
+    static constexpr size_t MIN_TASK_FLOPS = size_t(1) << 18; // work below which a chunk is not worth a task
+
+    size_t numThreads;           // Number of chunks per batch
+    shared_ptr<ThreadPool> pool; // Workers executing the chunks
+
+    /**
+     * @brief Computes c = a * b, c already has the right shape
+     */
+    static void multiplyOne(const BasicMatrix<T> &a, const BasicMatrix<T> &b, BasicMatrix<R> &c);
+
+public:
+    /**
+     * @brief Construct a new Batch Multiplier object with its own thread pool
+     * @param numThreads Number of worker threads
+     * @throw std::invalid_argument if numThreads is zero
+     */
+    explicit BasicBatchMultiplier(size_t numThreads = ThreadPool::defaultSize());
+
+    /**
+     * @brief Construct a new Batch Multiplier object running on a shared pool
+     * @param pool Pool to run the chunks on, may be shared with other multipliers
+     * @param numThreads Number of chunks, 0 means one per pool worker
+     * @throw std::invalid_argument if pool is null
+     */
+    explicit BasicBatchMultiplier(shared_ptr<ThreadPool> pool, size_t numThreads = 0);
+
+    /**
+     * @brief Computes c[i] = a[i] * b[i] for every i of the batch
+     * @param a First matrices, all of one shape
+     * @param b Second matrices, all of one shape
+     * @param c Results; matrices of the wrong shape are replaced by arena-backed ones
+     * @param count Number of products
+     * @throw std::invalid_argument if the shapes differ within a batch or cannot be multiplied
+     */
+    void multiplyBatch(const BasicMatrix<T> *a, const BasicMatrix<T> *b, BasicMatrix<R> *c, size_t count);
+
+#ifdef __cpp_lib_span
+    /**
+     * @brief Computes c[i] = a[i] * b[i] for every i of the batch
+     * @param a First matrices, all of one shape
+     * @param b Second matrices, all of one shape
+     * @param c Results, as many as products; matrices of the wrong shape are replaced
+     * @throw std::invalid_argument if the spans have different lengths or the shapes do not fit
+     */
+    void multiplyBatch(span<const BasicMatrix<T>> a, span<const BasicMatrix<T>> b, span<BasicMatrix<R>> c);
+#endif
+
+    /**
+     * @brief Computes the products of a batch into new arena-backed matrices
+     * @param a First matrices, all of one shape
+     * @param b Second matrices, all of one shape
+     * @return vector<BasicMatrix<R>> - a[i] * b[i], stored in one arena
+     * @throw std::invalid_argument if the vectors have different lengths or the shapes do not fit
+     */
+    vector<BasicMatrix<R>> multiplyBatch(const vector<BasicMatrix<T>> &a, const vector<BasicMatrix<T>> &b);
+
+    /**
+     * @brief Gets the name of the multiplication algorithm
+     * @return const char* - "Batched" as the algorithm identifier
+     */
+    const char *getName() const { return "Batched"; }
+};
+
+template <typename T, typename R>
+BasicBatchMultiplier<T, R>::BasicBatchMultiplier(size_t numThreads)
+    : numThreads(numThreads)
+{
+    if (numThreads == 0)
+    {
+        throw std::invalid_argument("Number of threads must be positive");
+    }
+    pool = make_shared<ThreadPool>(numThreads);
+}
+
+template <typename T, typename R>
+BasicBatchMultiplier<T, R>::BasicBatchMultiplier(shared_ptr<ThreadPool> pool, size_t numThreads)
+    : numThreads(numThreads), pool(std::move(pool))
+{
+    if (!this->pool)
+    {
+        throw std::invalid_argument("Thread pool must not be null");
+    }
+    if (this->numThreads == 0)
+    {
+        this->numThreads = this->pool->size();
+    }
+}
+
+template <typename T, typename R>
+void BasicBatchMultiplier<T, R>::multiplyOne(const BasicMatrix<T> &a, const BasicMatrix<T> &b, BasicMatrix<R> &c)
+{
+    const size_t n = a.getRows();
+    const size_t inner = a.getCols();
+    const size_t m = b.getCols();
+    memset(c.data(), 0, n * c.getStride() * sizeof(R));
+
+    if constexpr (is_same_v<T, double> && is_same_v<R, double>)
+    {
+        // multiplyAdd keeps no state, so one instance serves every thread
+        static const SimdMultiplier simd;
+        simd.multiplyAdd(n, m, inner, a.data(), a.getStride(), b.data(), b.getStride(), c.data(), c.getStride());
+    }
+    else
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            R *cRow = c.rowPtr(i);
+            for (size_t k = 0; k < inner; ++k)
+            {
+                const R aik = static_cast<R>(a.at(i, k));
+                const T *bRow = b.rowPtr(k);
+                for (size_t j = 0; j < m; ++j)
+                {
+                    cRow[j] += aik * static_cast<R>(bRow[j]);
+                }
+            }
+        }
+    }
+}
+
+template <typename T, typename R>
+void BasicBatchMultiplier<T, R>::multiplyBatch(const BasicMatrix<T> *a, const BasicMatrix<T> *b,
+                                               BasicMatrix<R> *c, size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    const size_t n = a[0].getRows();
+    const size_t inner = a[0].getCols();
+    const size_t m = b[0].getCols();
+    if (n == 0 || inner == 0 || m == 0 || b[0].getRows() == 0)
+    {
+        throw std::invalid_argument("Cannot multiply empty matrices");
+    }
+    if (b[0].getRows() != inner)
+    {
+        throw std::invalid_argument("Matrix dimensions are not compatible for multiplication");
+    }
+
+    vector<size_t> unshaped; // outputs that need storage of the result shape
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (a[i].getRows() != n || a[i].getCols() != inner || b[i].getRows() != inner || b[i].getCols() != m)
+        {
+            throw std::invalid_argument("All matrices of a batch must have the same shape");
+        }
+        // multiplyOne zeroes c before reading the operands, and reshaping c would free them
+        const void *target = c[i].data();
+        if (target && (target == static_cast<const void *>(a[i].data()) ||
+                       target == static_cast<const void *>(b[i].data())))
+        {
+            throw std::invalid_argument("Output matrix must not share storage with an operand");
+        }
+        if (c[i].getRows() != n || c[i].getCols() != m)
+        {
+            unshaped.push_back(i);
+        }
+    }
+
+    if (!unshaped.empty())
+    {
+        vector<BasicMatrix<R>> fresh = BasicMatrix<R>::makeBatch(unshaped.size(), n, m);
+        for (size_t i = 0; i < unshaped.size(); ++i)
+        {
+            c[unshaped[i]] = std::move(fresh[i]);
+        }
+    }
+
+    auto runChunk = [a, b, c](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            multiplyOne(a[i], b[i], c[i]);
+        }
+    };
+
+    // chunks must carry enough work to pay for being scheduled
+    const size_t flops = 2 * n * inner * m;
+    const size_t chunks = min(numThreads, max<size_t>(1, count * flops / MIN_TASK_FLOPS));
+    if (chunks <= 1)
+    {
+        runChunk(0, count);
+        return;
+    }
+
+    vector<future<void>> tasks;
+    for (size_t t = 0; t < chunks; ++t)
+    {
+        const size_t begin = count * t / chunks;
+        const size_t end = count * (t + 1) / chunks;
+        tasks.push_back(pool->submit([&runChunk, begin, end]
+                                     { runChunk(begin, end); }));
+    }
+    // every chunk refers to runChunk, so all of them finish before an exception leaves this frame
+    ThreadPool::waitAll(tasks);
+}
+
+#ifdef __cpp_lib_span
+template <typename T, typename R>
+void BasicBatchMultiplier<T, R>::multiplyBatch(span<const BasicMatrix<T>> a, span<const BasicMatrix<T>> b,
+                                               span<BasicMatrix<R>> c)
+{
+    if (a.size() != b.size() || a.size() != c.size())
+    {
+        throw std::invalid_argument("Batch sizes do not match");
+    }
+    multiplyBatch(a.data(), b.data(), c.data(), a.size());
+}
+#endif
+
+template <typename T, typename R>
+vector<BasicMatrix<R>> BasicBatchMultiplier<T, R>::multiplyBatch(const vector<BasicMatrix<T>> &a,
+                                                                 const vector<BasicMatrix<T>> &b)
+{
+    if (a.size() != b.size())
+    {
+        throw std::invalid_argument("Batch sizes do not match");
+    }
+    if (a.empty())
+    {
+        return {};
+    }
+
+    vector<BasicMatrix<R>> c = BasicMatrix<R>::makeBatch(a.size(), a[0].getRows(), b[0].getCols());
+    multiplyBatch(a.data(), b.data(), c.data(), a.size());
+    return c;
+}
+
+/**
+ * @brief Batch multiplier of double matrices
+ */
+using BatchMultiplier = BasicBatchMultiplier<double>;
+
+template class BasicBatchMultiplier<float>;
+template class BasicBatchMultiplier<double>;
+template class BasicBatchMultiplier<int32_t>;
+template class BasicBatchMultiplier<int64_t>;
+template class BasicBatchMultiplier<int8_t, int32_t>;
+template class BasicBatchMultiplier<int16_t, int32_t>;
@@ -0,0 +1,353 @@
+#pragma once
+#include "Matrix.h"
+#include "Philox.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Dense 0/1 matrix storing 64 entries per machine word
+ *
+ * Entry (i, j) is bit j % 64 of word j / 64 of row i. Rows are padded to a
+ * whole number of BLOCK_WORDS words (512 bits, one cache line) so that the
+ * boolean kernels of BooleanMultiplier can work on full blocks; the padding
+ * bits are always zero. Compared with a Matrix of doubles the matrix takes
+ * 64 times less memory, e.g. 50 MB instead of 3.2 GB for 20000 x 20000.
+ */
+class BitMatrix
+{
+public:
+    static constexpr size_t WORD_BITS = 64;
+    static constexpr size_t BLOCK_WORDS = 8; // rows are padded to a multiple of this many words
+
+private:
+    size_t rows;           // Number of rows in the matrix
+    size_t cols;           // Number of columns in the matrix
+    size_t stride;         // Number of words per row, a multiple of BLOCK_WORDS
+    vector<uint64_t> bits; // rows * stride words, row by row
+
+    /**
+     * @brief Transposes a 64 x 64 bit block in place, word k being row k
+     */
+    static void transposeBlock(uint64_t block[WORD_BITS]);
+
+public:
+    /**
+     * @brief Construct a new Bit Matrix object with all entries false
+     * @param rows Number of rows in the matrix
+     * @param cols Number of columns in the matrix
+     */
+    BitMatrix(size_t rows, size_t cols);
+
+    /**
+     * @brief Packs a dense matrix, every non-zero element becoming true
+     * @param matrix Matrix to pack
+     * @return BitMatrix - the non-zero pattern of matrix
+     */
+    template <typename T>
+    static BitMatrix fromMatrix(const BasicMatrix<T> &matrix);
+
+    /**
+     * @brief Packs a square adjacency matrix given as an array of bool rows
+     * @param adjacency adjacency[i][j] is true for an edge from i to j
+     * @param vertices Number of vertices (rows and columns)
+     * @return BitMatrix - the adjacency matrix
+     * @throw std::invalid_argument if adjacency is null while vertices is not zero
+     */
+    static BitMatrix fromAdjacency(const bool *const *adjacency, size_t vertices);
+
+    /**
+     * @brief Packs the adjacency matrix of a graph
+     *
+     * Works with any graph exposing getVertices() and getAdjMatrix() as
+     * bool rows, such as MatrixGraph from the first semester.
+     *
+     * @param graph Graph to convert
+     * @return BitMatrix - its adjacency matrix
+     */
+    template <typename Graph>
+    static BitMatrix fromGraph(Graph &graph)
+    {
+        return fromAdjacency(graph.getAdjMatrix(), static_cast<size_t>(graph.getVertices()));
+    }
+
+    /**
+     * @brief Creates an identity matrix
+     * @param size Number of rows and columns
+     * @return BitMatrix - true on the diagonal only
+     */
+    static BitMatrix identity(size_t size);
+
+    /**
+     * @brief Unpacks the matrix into a dense one of zeros and ones
+     * @return BasicMatrix<T> - 1 where the entry is true, 0 elsewhere
+     */
+    template <typename T = double>
+    BasicMatrix<T> toMatrix() const;
+
+    /**
+     * @brief Gets the number of rows in the matrix
+     * @return size_t - number of rows
+     */
+    size_t getRows() const { return rows; }
+
+    /**
+     * @brief Gets the number of columns in the matrix
+     * @return size_t - number of columns
+     */
+    size_t getCols() const { return cols; }
+
+    /**
+     * @brief Gets the number of words between the starts of two rows
+     * @return size_t - words per row, padding included
+     */
+    size_t getStride() const { return stride; }
+
+    /**
+     * @brief Gets the packed words of a row
+     * @param i Row index
+     * @return uint64_t* - getStride() words, bit j % 64 of word j / 64 being column j
+     */
+    uint64_t *rowPtr(size_t i) { return bits.data() + i * stride; }
+    const uint64_t *rowPtr(size_t i) const { return bits.data() + i * stride; }
+
+    /**
+     * @brief Gets an entry
+     * @param i Row index
+     * @param j Column index
+     * @return bool - value of the entry
+     */
+    bool get(size_t i, size_t j) const { return (rowPtr(i)[j / WORD_BITS] >> (j % WORD_BITS)) & 1; }
+
+    /**
+     * @brief Sets an entry
+     * @param i Row index
+     * @param j Column index
+     * @param value New value of the entry
+     */
+    void set(size_t i, size_t j, bool value = true);
+
+    /**
+     * @brief Fills the matrix with reproducible random bits
+     * @param seed Seed of the Philox stream
+     * @param density Probability of an entry being true
+     * @throw std::invalid_argument if density is outside [0, 1]
+     */
+    void randomize(uint64_t seed, double density = 0.5);
+
+    /**
+     * @brief Counts the true entries
+     * @return size_t - number of set bits
+     */
+    size_t count() const;
+
+    /**
+     * @brief Transposes the matrix 64 x 64 bits at a time
+     * @return BitMatrix - the transposed matrix
+     */
+    BitMatrix transpose() const;
+
+    /**
+     * @brief Sets every entry that is true in another matrix of the same size
+     * @param other Matrix to merge in
+     * @return BitMatrix& - this matrix
+     * @throw std::invalid_argument if the sizes differ
+     */
+    BitMatrix &operator|=(const BitMatrix &other);
+
+    /**
+     * @brief Compares two matrices entry by entry
+     */
+    bool operator==(const BitMatrix &other) const;
+    bool operator!=(const BitMatrix &other) const { return !(*this == other); }
+};
+
+BitMatrix::BitMatrix(size_t rows, size_t cols)
+    : rows(rows), cols(cols),
+      stride((cols + BLOCK_WORDS * WORD_BITS - 1) / (BLOCK_WORDS * WORD_BITS) * BLOCK_WORDS),
+      bits(rows * stride, 0)
+{
+}
+
+template <typename T>
+BitMatrix BitMatrix::fromMatrix(const BasicMatrix<T> &matrix)
+{
+    BitMatrix result(matrix.getRows(), matrix.getCols());
+    for (size_t i = 0; i < result.rows; ++i)
+    {
+        const T *src = matrix.rowPtr(i);
+        uint64_t *dst = result.rowPtr(i);
+        for (size_t j = 0; j < result.cols; ++j)
+        {
+            dst[j / WORD_BITS] |= uint64_t(src[j] != T(0)) << (j % WORD_BITS);
+        }
+    }
+    return result;
+}
+
+BitMatrix BitMatrix::fromAdjacency(const bool *const *adjacency, size_t vertices)
+{
+    if (!adjacency && vertices != 0)
+    {
+        throw std::invalid_argument("Adjacency matrix must not be null");
+    }
+    BitMatrix result(vertices, vertices);
+    for (size_t i = 0; i < vertices; ++i)
+    {
+        uint64_t *dst = result.rowPtr(i);
+        for (size_t j = 0; j < vertices; ++j)
+        {
+            dst[j / WORD_BITS] |= uint64_t(adjacency[i][j]) << (j % WORD_BITS);
+        }
+    }
+    return result;
+}
+
+BitMatrix BitMatrix::identity(size_t size)
+{
+    BitMatrix result(size, size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        result.set(i, i);
+    }
+    return result;
+}
+
+template <typename T>
+BasicMatrix<T> BitMatrix::toMatrix() const
+{
+    BasicMatrix<T> result = BasicMatrix<T>::makeUninitialized(rows, cols);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        const uint64_t *src = rowPtr(i);
+        T *dst = result.rowPtr(i);
+        for (size_t j = 0; j < cols; ++j)
+        {
+            dst[j] = static_cast<T>((src[j / WORD_BITS] >> (j % WORD_BITS)) & 1);
+        }
+    }
+    return result;
+}
+
+void BitMatrix::set(size_t i, size_t j, bool value)
+{
+    const uint64_t mask = uint64_t(1) << (j % WORD_BITS);
+    uint64_t &word = rowPtr(i)[j / WORD_BITS];
+    word = value ? word | mask : word & ~mask;
+}
+
+void BitMatrix::randomize(uint64_t seed, double density)
+{
+    if (!(density >= 0.0 && density <= 1.0))
+    {
+        throw std::invalid_argument("Density must be between 0 and 1");
+    }
+
+    const Philox4x32::Key key = Philox4x32::makeKey(seed);
+    const size_t used = (cols + WORD_BITS - 1) / WORD_BITS;
+    for (size_t i = 0; i < rows; ++i)
+    {
+        uint64_t *row = rowPtr(i);
+        for (size_t w = 0; w < used; ++w)
+        {
+            uint64_t word = 0;
+            if (density == 0.5)
+            {
+                // one Philox block gives 128 fair bits, two words
+                const Philox4x32::Counter r = Philox4x32::generate(
+                    {uint32_t(w / 2), uint32_t(w / 2 >> 32), uint32_t(i), uint32_t(uint64_t(i) >> 32)}, key);
+                word = w % 2 ? (uint64_t(r[3]) << 32) | r[2] : (uint64_t(r[1]) << 32) | r[0];
+            }
+            else
+            {
+                for (size_t b = 0; b < WORD_BITS; b += 4)
+                {
+                    const uint64_t block = (w * WORD_BITS + b) / 4;
+                    const Philox4x32::Counter r = Philox4x32::generate(
+                        {uint32_t(block), uint32_t(block >> 32), uint32_t(i), uint32_t(uint64_t(i) >> 32)}, key);
+                    for (size_t l = 0; l < 4; ++l)
+                    {
+                        word |= uint64_t(Philox4x32::toUnitFloat(r[l]) < density) << (b + l);
+                    }
+                }
+            }
+            // keep the bits past the last column zero
+            if ((w + 1) * WORD_BITS > cols)
+            {
+                word &= (uint64_t(1) << (cols % WORD_BITS)) - 1;
+            }
+            row[w] = word;
+        }
+    }
+}
+
+size_t BitMatrix::count() const
+{
+    size_t total = 0;
+    for (uint64_t word : bits)
+    {
+        total += static_cast<size_t>(__builtin_popcountll(word));
+    }
+    return total;
+}
+
+void BitMatrix::transposeBlock(uint64_t block[WORD_BITS])
+{
+    // swap the off-diagonal halves of ever smaller sub-blocks: 32 x 32, 16 x 16, ..., 1 x 1
+    uint64_t mask = 0x00000000FFFFFFFFull;
+    for (size_t j = 32; j != 0; j >>= 1, mask ^= mask << j)
+    {
+        for (size_t k = 0; k < WORD_BITS; k = ((k | j) + 1) & ~j)
+        {
+            const uint64_t t = ((block[k] >> j) ^ block[k | j]) & mask;
+            block[k] ^= t << j;
+            block[k | j] ^= t;
+        }
+    }
+}
+
+BitMatrix BitMatrix::transpose() const
+{
+    BitMatrix result(cols, rows);
+    uint64_t block[WORD_BITS];
+    for (size_t i0 = 0; i0 < rows; i0 += WORD_BITS)
+    {
+        const size_t height = min(WORD_BITS, rows - i0);
+        for (size_t j0 = 0; j0 < cols; j0 += WORD_BITS)
+        {
+            const size_t width = min(WORD_BITS, cols - j0);
+            for (size_t k = 0; k < WORD_BITS; ++k)
+            {
+                block[k] = k < height ? rowPtr(i0 + k)[j0 / WORD_BITS] : 0;
+            }
+            transposeBlock(block);
+            for (size_t k = 0; k < width; ++k)
+            {
+                result.rowPtr(j0 + k)[i0 / WORD_BITS] = block[k];
+            }
+        }
+    }
+    return result;
+}
+
+BitMatrix &BitMatrix::operator|=(const BitMatrix &other)
+{
+    if (rows != other.rows || cols != other.cols)
+    {
+        throw std::invalid_argument("Matrices must have the same size");
+    }
+    for (size_t w = 0; w < bits.size(); ++w)
+    {
+        bits[w] |= other.bits[w];
+    }
+    return *this;
+}
+
+bool BitMatrix::operator==(const BitMatrix &other) const
+{
+    // padding bits are always zero, so whole rows can be compared
+    return rows == other.rows && cols == other.cols && bits == other.bits;
+}
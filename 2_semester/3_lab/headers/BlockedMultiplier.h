@@ -0,0 +1,94 @@
+#pragma once
+#include "MatrixMultiplier.h"
+#include "SimdMultiplier.h"
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * @brief Cache-blocked (tiled) implementation of matrix multiplication
+ *
+ * The i, j and k loops are split into tiles so that the data touched by the
+ * innermost loops stays in cache:
+ *  - colBlock columns of B and C form a panel sized for the L3 cache,
+ *  - innerBlock x colBlock block of B is reused by every row of A (L2 cache),
+ *  - rowBlock rows of A and C are processed against that block (L1 cache).
+ * Every tile is multiplied by the register-blocked, vectorized micro-kernel
+ * of SimdMultiplier (multiplyAdd on views of the tile), so the speedup over
+ * the scalar i-k-j loop does not depend on the compiler auto-vectorizing
+ * it: at n=1000 it holds at -O2 as well as in the unoptimized -g build.
+ */
+class BlockedMultiplier : public MatrixMultiplier
+{
+private:
+    size_t rowBlock;   // rows of A/C per tile (L1)
+    size_t innerBlock; // shared dimension per tile (L2)
+    size_t colBlock;   // columns of B/C per tile (L3)
+    SimdMultiplier simd; // micro-kernel run on every tile
+
+protected:
+    /**
+     * @brief Multiplies two matrices tile by tile into a caller-owned output
+     * @param a First matrix
+     * @param b Second matrix
+     * @param out Receives (or accumulates) the product
+     * @param mode Overwrite out or add the product to it
+     * @param alpha Scale applied to the product
+     */
+    void compute(const Matrix &a, const Matrix &b, Matrix &out, Accumulate mode, double alpha) override;
+
+public:
+    /**
+     * @brief Construct a new Blocked Multiplier object
+     * @param rowBlock Number of rows of A processed per tile
+     * @param innerBlock Number of columns of A (rows of B) processed per tile
+     * @param colBlock Number of columns of B processed per tile
+     * @throw std::invalid_argument if any block size is zero
+     */
+    explicit BlockedMultiplier(size_t rowBlock = 64, size_t innerBlock = 128, size_t colBlock = 512);
+
+    /**
+     * @brief Gets the name of the multiplication algorithm
+     * @return const char* - "Blocked" as the algorithm identifier
+     */
+    const char *getName() const override { return "Blocked"; }
+};
+
+BlockedMultiplier::BlockedMultiplier(size_t rowBlock, size_t innerBlock, size_t colBlock)
+    : rowBlock(rowBlock), innerBlock(innerBlock), colBlock(colBlock)
+{
+    if (rowBlock == 0 || innerBlock == 0 || colBlock == 0)
+    {
+        throw std::invalid_argument("Block sizes must be positive");
+    }
+}
+
+void BlockedMultiplier::compute(const Matrix &a, const Matrix &b, Matrix &out, Accumulate mode,
+                                double alpha)
+{
+    prepareOutput(a, b, out, mode);
+
+    const size_t n = a.getRows();
+    const size_t m = b.getCols();
+    const size_t inner = a.getCols();
+
+    // every block of the three loops below is one tile
+    startTiles(((n + rowBlock - 1) / rowBlock) * ((inner + innerBlock - 1) / innerBlock) *
+               ((m + colBlock - 1) / colBlock));
+    for (size_t jj = 0; jj < m; jj += colBlock)
+    {
+        size_t jEnd = min(jj + colBlock, m);
+        for (size_t kk = 0; kk < inner; kk += innerBlock)
+        {
+            size_t kEnd = min(kk + innerBlock, inner);
+            for (size_t ii = 0; ii < n; ii += rowBlock)
+            {
+                size_t iEnd = min(ii + rowBlock, n);
+
+                // multiply tile A[ii..iEnd, kk..kEnd] by B[kk..kEnd, jj..jEnd]
+                simd.multiplyAdd(iEnd - ii, jEnd - jj, kEnd - kk, a.rowPtr(ii) + kk, a.getStride(),
+                                 b.rowPtr(kk) + jj, b.getStride(), out.rowPtr(ii) + jj, out.getStride(), alpha);
+                finishTile();
+            }
+        }
+    }
+}
@@ -0,0 +1,354 @@
+#pragma once
+#include "BitMatrix.h"
+#include "SimdMultiplier.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef __GNUC__
+#define BOOLEAN_KERNEL_INLINE inline __attribute__((always_inline))
+#else
+#define BOOLEAN_KERNEL_INLINE inline
+#endif
+
+/**
+ * @brief Products of 0/1 matrices packed in BitMatrix
+ *
+ * multiply() computes the boolean product, C[i][j] = OR over k of
+ * (A[i][k] AND B[k][j]), with the Method of Four Russians: the shared
+ * dimension is cut into groups of 8, and for each group a table of all 256
+ * ORs of its 8 rows of B is built once. Every row of A then picks the
+ * table entry named by its 8 bits of the group and ORs it into its row of
+ * C, so one lookup replaces 8 row operations, each of which already handles
+ * 64 columns per word. Two groups are looked up together, and the work is
+ * blocked so that the tables (32 KB) and a block of C stay in cache:
+ * ROW_BLOCK rows of C by BLOCK_WORDS words (512 columns) at a time.
+ *
+ * countPaths() computes the integer product instead, the number of k with
+ * A[i][k] and B[k][j] (for an adjacency matrix squared, the number of walks
+ * of length 2), as the popcount of the AND of row i of A and column j of B.
+ *
+ * Both kernels are compiled twice, portable and for AVX2 with POPCNT; the
+ * wide version is chosen at construction when the CPU supports it. Rows of
+ * C are split into strips, one per thread.
+ */
+class BooleanMultiplier
+{
+public:
+    static constexpr size_t ROW_BLOCK = 1024; // rows of C per cache block
+    static constexpr size_t GROUP_BITS = 8;   // rows of B per Four Russians table
+    static constexpr size_t TABLE_SIZE = size_t(1) << GROUP_BITS;
+
+private:
+    static constexpr size_t BW = BitMatrix::BLOCK_WORDS;
+    static constexpr size_t PATH_BLOCK = 64; // columns of the paths result per cache block
+
+    using Kernel = void (*)(const BitMatrix &a, const BitMatrix &b, void *c, size_t begin, size_t end);
+
+    size_t numThreads;           // Number of row strips per product
+    shared_ptr<ThreadPool> pool; // Workers computing the strips
+    bool wide;                   // Whether the AVX2 + POPCNT kernels are used
+
+    /**
+     * @brief Fills table[m] with the OR of the rows k0 + bit of B, word block w, for every bit set in m
+     */
+    static BOOLEAN_KERNEL_INLINE void buildTable(const BitMatrix &b, size_t k0, size_t w, uint64_t *table);
+
+    /**
+     * @brief Computes rows begin..end of the boolean product into c, which is zeroed
+     */
+    static BOOLEAN_KERNEL_INLINE void fourRussians(const BitMatrix &a, const BitMatrix &b, BitMatrix &c,
+                                                   size_t begin, size_t end);
+
+    /**
+     * @brief Computes rows begin..end of the path counts from a and the transpose of b
+     */
+    static BOOLEAN_KERNEL_INLINE void countRows(const BitMatrix &a, const BitMatrix &bt, BasicMatrix<int32_t> &c,
+                                                size_t begin, size_t end);
+
+    static void fourRussiansPortable(const BitMatrix &a, const BitMatrix &b, void *c, size_t begin, size_t end);
+    static void countRowsPortable(const BitMatrix &a, const BitMatrix &bt, void *c, size_t begin, size_t end);
+#ifdef MATRIX_SIMD_X86
+    __attribute__((target("avx2,popcnt"))) static void fourRussiansAvx2(const BitMatrix &a, const BitMatrix &b,
+                                                                         void *c, size_t begin, size_t end);
+    __attribute__((target("avx2,popcnt"))) static void countRowsAvx2(const BitMatrix &a, const BitMatrix &bt,
+                                                                      void *c, size_t begin, size_t end);
+#endif
+
+    /**
+     * @brief Runs kernel over row strips of the result on the pool
+     */
+    void runStrips(Kernel kernel, const BitMatrix &a, const BitMatrix &b, void *c, size_t rows);
+
+    /**
+     * @brief Checks that a * b is defined
+     */
+    static void validate(const BitMatrix &a, const BitMatrix &b);
+
+public:
+    /**
+     * @brief Construct a new Boolean Multiplier object with its own thread pool
+     * @param numThreads Number of worker threads
+     * @throw std::invalid_argument if numThreads is zero
+     */
+    explicit BooleanMultiplier(size_t numThreads = ThreadPool::defaultSize());
+
+    /**
+     * @brief Construct a new Boolean Multiplier object running on a shared pool
+     * @param pool Pool to run the strips on, may be shared with other multipliers
+     * @param numThreads Number of strips, 0 means one per pool worker
+     * @throw std::invalid_argument if pool is null
+     */
+    explicit BooleanMultiplier(shared_ptr<ThreadPool> pool, size_t numThreads = 0);
+
+    /**
+     * @brief Checks whether the CPU runs the AVX2 + POPCNT kernels
+     * @return true if they are used, false for the portable ones
+     */
+    static bool isAccelerated();
+
+    /**
+     * @brief Computes the boolean product of two matrices
+     * @param a First matrix
+     * @param b Second matrix
+     * @return BitMatrix - true where some k has a[i][k] and b[k][j]
+     * @throw std::invalid_argument if the matrices are empty or incompatible
+     */
+    BitMatrix multiply(const BitMatrix &a, const BitMatrix &b);
+
+    /**
+     * @brief Counts, for every entry of the product, the k that make it true
+     * @param a First matrix
+     * @param b Second matrix
+     * @return BasicMatrix<int32_t> - the integer product of the 0/1 matrices
+     * @throw std::invalid_argument if the matrices are empty or incompatible
+     */
+    BasicMatrix<int32_t> countPaths(const BitMatrix &a, const BitMatrix &b);
+
+    /**
+     * @brief Gets the name of the multiplication algorithm
+     * @return const char* - "Four Russians", with the kernel when it is vectorized
+     */
+    const char *getName() const { return wide ? "Four Russians AVX2" : "Four Russians"; }
+};
+
+BooleanMultiplier::BooleanMultiplier(size_t numThreads) : numThreads(numThreads), wide(isAccelerated())
+{
+    if (numThreads == 0)
+    {
+        throw std::invalid_argument("Number of threads must be positive");
+    }
+    pool = make_shared<ThreadPool>(numThreads);
+}
+
+BooleanMultiplier::BooleanMultiplier(shared_ptr<ThreadPool> pool, size_t numThreads)
+    : numThreads(numThreads), pool(std::move(pool)), wide(isAccelerated())
+{
+    if (!this->pool)
+    {
+        throw std::invalid_argument("Thread pool must not be null");
+    }
+    if (this->numThreads == 0)
+    {
+        this->numThreads = this->pool->size();
+    }
+}
+
+bool BooleanMultiplier::isAccelerated()
+{
+#ifdef MATRIX_SIMD_X86
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#else
+    return false;
+#endif
+}
+
+void BooleanMultiplier::buildTable(const BitMatrix &b, size_t k0, size_t w, uint64_t *table)
+{
+    // entries 2^bit .. 2^(bit+1) are entries 0 .. 2^bit plus row k0 + bit; rows past the end count as zero
+    for (size_t l = 0; l < BW; ++l)
+    {
+        table[l] = 0;
+    }
+    for (size_t bit = 0; bit < GROUP_BITS; ++bit)
+    {
+        const size_t top = size_t(1) << bit;
+        uint64_t *dst = table + top * BW;
+        if (k0 + bit >= b.getRows())
+        {
+            copy(table, table + top * BW, dst);
+            continue;
+        }
+        const uint64_t *row = b.rowPtr(k0 + bit) + w;
+        for (size_t m = 0; m < top; ++m)
+        {
+            for (size_t l = 0; l < BW; ++l)
+            {
+                dst[m * BW + l] = table[m * BW + l] | row[l];
+            }
+        }
+    }
+}
+
+void BooleanMultiplier::fourRussians(const BitMatrix &a, const BitMatrix &b, BitMatrix &c, size_t begin, size_t end)
+{
+    const size_t groups = (a.getCols() + GROUP_BITS - 1) / GROUP_BITS;
+    vector<uint64_t> tables(2 * TABLE_SIZE * BW);
+    uint64_t *low = tables.data();
+    uint64_t *high = low + TABLE_SIZE * BW;
+
+    for (size_t i0 = begin; i0 < end; i0 += ROW_BLOCK)
+    {
+        const size_t i1 = min(i0 + ROW_BLOCK, end);
+        for (size_t w = 0; w < c.getStride(); w += BW)
+        {
+            // two groups per pass: 16 bits of A, always inside one word since groups are byte aligned
+            for (size_t g = 0; g < groups; g += 2)
+            {
+                buildTable(b, g * GROUP_BITS, w, low);
+                buildTable(b, (g + 1) * GROUP_BITS, w, high);
+                const size_t word = g * GROUP_BITS / BitMatrix::WORD_BITS;
+                const size_t shift = g * GROUP_BITS % BitMatrix::WORD_BITS;
+                for (size_t i = i0; i < i1; ++i)
+                {
+                    const uint64_t bits = a.rowPtr(i)[word] >> shift;
+                    const size_t lo = bits & (TABLE_SIZE - 1);
+                    const size_t hi = (bits >> GROUP_BITS) & (TABLE_SIZE - 1);
+                    if ((lo | hi) == 0)
+                    {
+                        continue; // common for sparse graphs
+                    }
+                    const uint64_t *x = low + lo * BW;
+                    const uint64_t *y = high + hi * BW;
+                    uint64_t *dst = c.rowPtr(i) + w;
+                    for (size_t l = 0; l < BW; ++l)
+                    {
+                        dst[l] |= x[l] | y[l];
+                    }
+                }
+            }
+        }
+    }
+}
+
+void BooleanMultiplier::countRows(const BitMatrix &a, const BitMatrix &bt, BasicMatrix<int32_t> &c, size_t begin,
+                                  size_t end)
+{
+    const size_t words = (a.getCols() + BitMatrix::WORD_BITS - 1) / BitMatrix::WORD_BITS;
+    const size_t cols = bt.getRows();
+
+    // a block of columns of B (rows of bt) stays in cache while the rows of the strip pass over it
+    for (size_t j0 = 0; j0 < cols; j0 += PATH_BLOCK)
+    {
+        const size_t j1 = min(j0 + PATH_BLOCK, cols);
+        for (size_t i = begin; i < end; ++i)
+        {
+            const uint64_t *aRow = a.rowPtr(i);
+            int32_t *cRow = c.rowPtr(i);
+            for (size_t j = j0; j < j1; ++j)
+            {
+                const uint64_t *bCol = bt.rowPtr(j);
+                size_t sum = 0;
+                for (size_t w = 0; w < words; ++w)
+                {
+                    sum += static_cast<size_t>(__builtin_popcountll(aRow[w] & bCol[w]));
+                }
+                cRow[j] = static_cast<int32_t>(sum);
+            }
+        }
+    }
+}
+
+void BooleanMultiplier::fourRussiansPortable(const BitMatrix &a, const BitMatrix &b, void *c, size_t begin,
+                                             size_t end)
+{
+    fourRussians(a, b, *static_cast<BitMatrix *>(c), begin, end);
+}
+
+void BooleanMultiplier::countRowsPortable(const BitMatrix &a, const BitMatrix &bt, void *c, size_t begin,
+                                          size_t end)
+{
+    countRows(a, bt, *static_cast<BasicMatrix<int32_t> *>(c), begin, end);
+}
+
+#ifdef MATRIX_SIMD_X86
+// the same code as above, inlined into functions compiled for AVX2: the word loops become 256-bit ORs
+// and __builtin_popcountll a single POPCNT instruction
+void BooleanMultiplier::fourRussiansAvx2(const BitMatrix &a, const BitMatrix &b, void *c, size_t begin, size_t end)
+{
+    fourRussians(a, b, *static_cast<BitMatrix *>(c), begin, end);
+}
+
+void BooleanMultiplier::countRowsAvx2(const BitMatrix &a, const BitMatrix &bt, void *c, size_t begin, size_t end)
+{
+    countRows(a, bt, *static_cast<BasicMatrix<int32_t> *>(c), begin, end);
+}
+#endif
+
+void BooleanMultiplier::runStrips(Kernel kernel, const BitMatrix &a, const BitMatrix &b, void *c, size_t rows)
+{
+    // strips of at least 64 rows; every strip needs its own tables
+    const size_t parts = min(numThreads, max<size_t>(1, rows / BitMatrix::WORD_BITS));
+    if (parts <= 1)
+    {
+        kernel(a, b, c, 0, rows);
+        return;
+    }
+
+    vector<future<void>> tasks;
+    for (size_t p = 0; p < parts; ++p)
+    {
+        const size_t begin = p * rows / parts;
+        const size_t end = (p + 1) * rows / parts;
+        tasks.push_back(pool->submit([kernel, &a, &b, c, begin, end]
+                                     { kernel(a, b, c, begin, end); }));
+    }
+    ThreadPool::waitAll(tasks);
+}
+
+void BooleanMultiplier::validate(const BitMatrix &a, const BitMatrix &b)
+{
+    if (a.getRows() == 0 || a.getCols() == 0 || b.getRows() == 0 || b.getCols() == 0)
+    {
+        throw std::invalid_argument("Cannot multiply empty matrices");
+    }
+    if (a.getCols() != b.getRows())
+    {
+        throw std::invalid_argument("Matrix dimensions are not compatible for multiplication");
+    }
+}
+
+BitMatrix BooleanMultiplier::multiply(const BitMatrix &a, const BitMatrix &b)
+{
+    validate(a, b);
+    BitMatrix c(a.getRows(), b.getCols());
+    Kernel kernel = &BooleanMultiplier::fourRussiansPortable;
+#ifdef MATRIX_SIMD_X86
+    if (wide)
+    {
+        kernel = &BooleanMultiplier::fourRussiansAvx2;
+    }
+#endif
+    runStrips(kernel, a, b, &c, c.getRows());
+    return c;
+}
+
+BasicMatrix<int32_t> BooleanMultiplier::countPaths(const BitMatrix &a, const BitMatrix &b)
+{
+    validate(a, b);
+    const BitMatrix bt = b.transpose();
+    BasicMatrix<int32_t> c = BasicMatrix<int32_t>::makeUninitialized(a.getRows(), b.getCols());
+    Kernel kernel = &BooleanMultiplier::countRowsPortable;
+#ifdef MATRIX_SIMD_X86
+    if (wide)
+    {
+        kernel = &BooleanMultiplier::countRowsAvx2;
+    }
+#endif
+    runStrips(kernel, a, bt, &c, c.getRows());
+    return c;
+}
@@ -0,0 +1,347 @@
+#pragma once
+#include "Matrix.h"
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Fully unrolled product of small matrices whose shape is known at compile time
+ *
+ * C = A * B for a Rows x Inner matrix A and an Inner x Cols matrix B. The
+ * loops are expanded by fold expressions over index sequences, so the
+ * compiler sees straight-line code: one row of C is accumulated in a local
+ * array (kept in registers) from Inner scaled rows of B, then stored.
+ * Operands are strided views, so the kernel works on FixedMatrix storage
+ * and on blocks of a Matrix alike. Everything is constexpr.
+ *
+ * @tparam T Element type
+ */
+template <typename T, size_t Rows, size_t Inner, size_t Cols>
+struct FixedKernel
+{
+    /**
+     * @brief C = alpha * A * B on row-major views
+     * @param a Pointer to A(0,0), rows lda elements apart
+     * @param b Pointer to B(0,0), rows ldb elements apart
+     * @param c Pointer to C(0,0), rows ldc elements apart; must not overlap A or B
+     * @param alpha Scale applied to every row of the product as it is stored
+     */
+    static constexpr void multiply(const T *a, size_t lda, const T *b, size_t ldb, T *c, size_t ldc, T alpha = T(1))
+    {
+        rows<false>(make_index_sequence<Rows>(), a, lda, b, ldb, c, ldc, alpha);
+    }
+
+    /**
+     * @brief C += alpha * A * B on row-major views
+     * @param a Pointer to A(0,0), rows lda elements apart
+     * @param b Pointer to B(0,0), rows ldb elements apart
+     * @param c Pointer to C(0,0), rows ldc elements apart; must not overlap A or B
+     * @param alpha Scale applied to every row of the product as it is stored
+     */
+    static constexpr void multiplyAdd(const T *a, size_t lda, const T *b, size_t ldb, T *c, size_t ldc,
+                                      T alpha = T(1))
+    {
+        rows<true>(make_index_sequence<Rows>(), a, lda, b, ldb, c, ldc, alpha);
+    }
+
+private:
+    template <bool Add, size_t... I>
+    static constexpr void rows(index_sequence<I...>, const T *a, size_t lda, const T *b, size_t ldb,
+                               T *c, size_t ldc, T alpha)
+    {
+        (row<Add>(a + I * lda, b, ldb, c + I * ldc, alpha), ...);
+    }
+
+    template <bool Add>
+    static constexpr void row(const T *aRow, const T *b, size_t ldb, T *cRow, T alpha)
+    {
+        T acc[Cols] = {};
+        inner(make_index_sequence<Inner>(), aRow, b, ldb, acc);
+        store<Add>(make_index_sequence<Cols>(), acc, cRow, alpha);
+    }
+
+    template <size_t... K>
+    static constexpr void inner(index_sequence<K...>, const T *aRow, const T *b, size_t ldb, T *acc)
+    {
+        (axpy(make_index_sequence<Cols>(), aRow[K], b + K * ldb, acc), ...);
+    }
+
+    template <size_t... J>
+    static constexpr void axpy(index_sequence<J...>, T scale, const T *bRow, T *acc)
+    {
+        ((acc[J] += scale * bRow[J]), ...);
+    }
+
+    template <bool Add, size_t... J>
+    static constexpr void store(index_sequence<J...>, const T *acc, T *cRow, T alpha)
+    {
+        if constexpr (Add)
+        {
+            ((cRow[J] += alpha * acc[J]), ...);
+        }
+        else
+        {
+            ((cRow[J] = alpha * acc[J]), ...);
+        }
+    }
+};
+
+/**
+ * @brief Non-owning fixed-size window into a Matrix
+ *
+ * Lets the unrolled kernels read and write a Rows x Cols block of a
+ * heap matrix in place, without copying it into a FixedMatrix.
+ *
+ * @tparam T Element type, const-qualified for a read-only view
+ */
+template <typename T, size_t Rows, size_t Cols>
+class FixedMatrixView
+{
+private:
+    template <typename, size_t, size_t>
+    friend class FixedMatrixView;
+
+    using Element = remove_const_t<T>;
+    using Source = conditional_t<is_const_v<T>, const BasicMatrix<Element>, BasicMatrix<Element>>;
+
+    T *origin;     // element (0,0) of the window
+    size_t stride; // distance between rows of the underlying matrix
+
+public:
+    /**
+     * @brief Construct a new Fixed Matrix View object
+     * @param matrix Matrix to look into
+     * @param row Top row of the window
+     * @param col Left column of the window
+     * @throw std::out_of_range if the window does not fit in the matrix
+     */
+    FixedMatrixView(Source &matrix, size_t row = 0, size_t col = 0);
+
+    /**
+     * @brief Turns a writable view into a read-only one
+     */
+    template <typename U, typename = enable_if_t<is_const_v<T> && is_same_v<U, Element>>>
+    FixedMatrixView(const FixedMatrixView<U, Rows, Cols> &other) : origin(other.origin), stride(other.stride) {}
+
+    static constexpr size_t getRows() { return Rows; }
+    static constexpr size_t getCols() { return Cols; }
+    size_t getStride() const { return stride; }
+
+    T &at(size_t i, size_t j) const { return origin[i * stride + j]; }
+    T *data() const { return origin; }
+};
+
+/**
+ * @brief Matrix with dimensions fixed at compile time, stored inline (on the stack)
+ *
+ * The elements are a plain array without padding, so a FixedMatrix needs no
+ * allocation and can be copied, returned and kept in arrays freely. The
+ * product uses FixedKernel, fully unrolled for the given shape; with the
+ * dimensions checked by the type system there is nothing to validate at
+ * run time. Conversions to and from Matrix copy the elements; a
+ * FixedMatrixView works on a block of a Matrix in place.
+ *
+ * @tparam T Element type
+ * @tparam Rows Number of rows
+ * @tparam Cols Number of columns
+ */
+template <typename T, size_t Rows, size_t Cols>
+class FixedMatrix
+{
+    static_assert(Rows > 0 && Cols > 0, "FixedMatrix dimensions must be positive");
+
+private:
+    T elements[Rows * Cols]; // row-major, Cols elements per row
+
+public:
+    /**
+     * @brief Construct a new Fixed Matrix object filled with zeros
+     */
+    constexpr FixedMatrix() : elements{} {}
+
+    /**
+     * @brief Construct a new Fixed Matrix object from rows of values
+     * @param values Rows x Cols values, row by row
+     * @throw std::invalid_argument if the number of rows or columns differs
+     */
+    constexpr FixedMatrix(initializer_list<initializer_list<T>> values);
+
+    /**
+     * @brief Copies a Matrix of the same shape
+     * @param matrix Matrix with Rows rows and Cols columns
+     * @throw std::invalid_argument if the shape differs
+     */
+    explicit FixedMatrix(const BasicMatrix<T> &matrix);
+
+    /**
+     * @brief Copies a Rows x Cols block (or view) out of a Matrix
+     * @param view Window into a matrix
+     */
+    explicit FixedMatrix(const FixedMatrixView<const T, Rows, Cols> &view);
+
+    static constexpr size_t getRows() { return Rows; }
+    static constexpr size_t getCols() { return Cols; }
+
+    /**
+     * @brief Accesses matrix element at specified position
+     * @param i Row index (0-based)
+     * @param j Column index (0-based)
+     * @return Reference to the element at position (i,j)
+     */
+    constexpr T &at(size_t i, size_t j) { return elements[i * Cols + j]; }
+    constexpr const T &at(size_t i, size_t j) const { return elements[i * Cols + j]; }
+
+    /**
+     * @brief Gets the raw storage, Rows * Cols elements row by row
+     * @return T* - pointer to element (0,0)
+     */
+    constexpr T *data() { return elements; }
+    constexpr const T *data() const { return elements; }
+
+    /**
+     * @brief Copies the elements into a new Matrix
+     * @return BasicMatrix<T> - heap matrix of the same shape
+     */
+    BasicMatrix<T> toMatrix() const;
+
+    /**
+     * @brief Copies the elements into a block of a Matrix
+     * @param view Window receiving the elements
+     */
+    void storeTo(const FixedMatrixView<T, Rows, Cols> &view) const;
+
+    /**
+     * @brief Compares two matrices element by element
+     */
+    constexpr bool operator==(const FixedMatrix &other) const;
+    constexpr bool operator!=(const FixedMatrix &other) const { return !(*this == other); }
+};
+
+template <typename T, size_t Rows, size_t Cols>
+FixedMatrixView<T, Rows, Cols>::FixedMatrixView(Source &matrix, size_t row, size_t col)
+    : origin(nullptr), stride(matrix.getStride())
+{
+    if (row + Rows > matrix.getRows() || col + Cols > matrix.getCols())
+    {
+        throw std::out_of_range("Fixed-size view does not fit in the matrix");
+    }
+    origin = matrix.rowPtr(row) + col;
+}
+
+template <typename T, size_t Rows, size_t Cols>
+constexpr FixedMatrix<T, Rows, Cols>::FixedMatrix(initializer_list<initializer_list<T>> values) : elements{}
+{
+    if (values.size() != Rows)
+    {
+        throw std::invalid_argument("Wrong number of rows for a fixed-size matrix");
+    }
+    size_t i = 0;
+    for (const auto &row : values)
+    {
+        if (row.size() != Cols)
+        {
+            throw std::invalid_argument("Wrong number of columns for a fixed-size matrix");
+        }
+        size_t j = 0;
+        for (const T &value : row)
+        {
+            elements[i * Cols + j++] = value;
+        }
+        ++i;
+    }
+}
+
+template <typename T, size_t Rows, size_t Cols>
+FixedMatrix<T, Rows, Cols>::FixedMatrix(const BasicMatrix<T> &matrix)
+{
+    if (matrix.getRows() != Rows || matrix.getCols() != Cols)
+    {
+        throw std::invalid_argument("Matrix shape does not match the fixed-size matrix");
+    }
+    for (size_t i = 0; i < Rows; ++i)
+    {
+        copy_n(matrix.rowPtr(i), Cols, elements + i * Cols);
+    }
+}
+
+template <typename T, size_t Rows, size_t Cols>
+FixedMatrix<T, Rows, Cols>::FixedMatrix(const FixedMatrixView<const T, Rows, Cols> &view)
+{
+    for (size_t i = 0; i < Rows; ++i)
+    {
+        copy_n(view.data() + i * view.getStride(), Cols, elements + i * Cols);
+    }
+}
+
+template <typename T, size_t Rows, size_t Cols>
+BasicMatrix<T> FixedMatrix<T, Rows, Cols>::toMatrix() const
+{
+    BasicMatrix<T> matrix(Rows, Cols);
+    storeTo(FixedMatrixView<T, Rows, Cols>(matrix));
+    return matrix;
+}
+
+template <typename T, size_t Rows, size_t Cols>
+void FixedMatrix<T, Rows, Cols>::storeTo(const FixedMatrixView<T, Rows, Cols> &view) const
+{
+    for (size_t i = 0; i < Rows; ++i)
+    {
+        copy_n(elements + i * Cols, Cols, view.data() + i * view.getStride());
+    }
+}
+
+template <typename T, size_t Rows, size_t Cols>
+constexpr bool FixedMatrix<T, Rows, Cols>::operator==(const FixedMatrix &other) const
+{
+    for (size_t k = 0; k < Rows * Cols; ++k)
+    {
+        if (elements[k] != other.elements[k])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Multiplies two fixed-size matrices with the unrolled kernel
+ * @return FixedMatrix<T, Rows, Cols> - the product, shapes checked at compile time
+ */
+template <typename T, size_t Rows, size_t Inner, size_t Cols>
+constexpr FixedMatrix<T, Rows, Cols> operator*(const FixedMatrix<T, Rows, Inner> &a, const FixedMatrix<T, Inner, Cols> &b)
+{
+    FixedMatrix<T, Rows, Cols> c;
+    FixedKernel<T, Rows, Inner, Cols>::multiply(a.data(), Inner, b.data(), Cols, c.data(), Cols);
+    return c;
+}
+
+/**
+ * @brief Multiplies blocks of matrices in place: c = a * b
+ * @param a Window of Rows x Inner elements, read-only or writable
+ * @param b Window of Inner x Cols elements, read-only or writable
+ * @param c Window receiving the product; must not overlap a or b
+ */
+template <typename A, typename B, typename T, size_t Rows, size_t Inner, size_t Cols>
+void multiplyFixed(const FixedMatrixView<A, Rows, Inner> &a, const FixedMatrixView<B, Inner, Cols> &b,
+                   const FixedMatrixView<T, Rows, Cols> &c)
+{
+    static_assert(is_same_v<remove_const_t<A>, T> && is_same_v<remove_const_t<B>, T>,
+                  "Views must have the same element type");
+
+    FixedKernel<T, Rows, Inner, Cols>::multiply(a.data(), a.getStride(), b.data(), b.getStride(),
+                                                c.data(), c.getStride());
+}
+
+/**
+ * @brief The fixed-size shapes used most often
+ */
+template <typename T>
+using FixedMatrix3 = FixedMatrix<T, 3, 3>;
+template <typename T>
+using FixedMatrix4 = FixedMatrix<T, 4, 4>;
+template <typename T>
+using FixedMatrix8 = FixedMatrix<T, 8, 8>;
+template <typename T>
+using FixedMatrix16 = FixedMatrix<T, 16, 16>;
@@ -0,0 +1,111 @@
+#pragma once
+#include "MatrixMultiplier.h"
+#include "FixedMatrix.h"
+#include "SequentialMultiplier.h"
+
+/**
+ * @brief Multiplier that routes common small square shapes to unrolled kernels
+ *
+ * Plugs the FixedKernel specialisations into the MatrixMultiplier family:
+ * 3x3, 4x4, 8x8 and 16x16 products are computed by the fully unrolled
+ * kernel for that size, picked by a switch on the run-time shape. Other
+ * shapes fall back to the packed sequential multiplier. Code that knows its
+ * shapes at compile time should use FixedMatrix directly and avoid the
+ * virtual call and the heap result as well.
+ *
+ * @tparam T Element type of the matrices and of the result
+ */
+template <typename T>
+class BasicFixedSizeMultiplier : public BasicMatrixMultiplier<T, T>
+{
+private:
+    BasicSequentialMultiplier<T, T> fallback; // shapes without a fixed kernel
+
+    /**
+     * @brief result = alpha * a * b (or result += alpha * a * b) with the unrolled N x N kernel
+     */
+    template <size_t N>
+    static void multiplyUnrolled(const BasicMatrix<T> &a, const BasicMatrix<T> &b, BasicMatrix<T> &result,
+                                 Accumulate mode, T alpha)
+    {
+        if (mode == Accumulate::Add)
+        {
+            FixedKernel<T, N, N, N>::multiplyAdd(a.data(), a.getStride(), b.data(), b.getStride(),
+                                                 result.data(), result.getStride(), alpha);
+            return;
+        }
+        FixedKernel<T, N, N, N>::multiply(a.data(), a.getStride(), b.data(), b.getStride(),
+                                          result.data(), result.getStride(), alpha);
+    }
+
+protected:
+    /**
+     * @brief Multiplies two matrices into a caller-owned output, unrolled for the supported square sizes
+     * @param a First matrix
+     * @param b Second matrix
+     * @param out Receives (or accumulates) the product
+     * @param mode Overwrite out or add the product to it
+     * @param alpha Scale applied to the product
+     */
+    void compute(const BasicMatrix<T> &a, const BasicMatrix<T> &b, BasicMatrix<T> &out,
+                 Accumulate mode, T alpha) override;
+
+public:
+    BasicFixedSizeMultiplier() : fallback(true) {}
+
+    /**
+     * @brief Checks whether a shape has an unrolled kernel
+     * @param n Size of the square matrices
+     * @return true for 3, 4, 8 and 16
+     */
+    static bool hasKernel(size_t n) { return n == 3 || n == 4 || n == 8 || n == 16; }
+
+    /**
+     * @brief Gets the name of the multiplication algorithm
+     * @return const char* - "Fixed-size" as the algorithm identifier
+     */
+    const char *getName() const override { return "Fixed-size"; }
+};
+
+template <typename T>
+void BasicFixedSizeMultiplier<T>::compute(const BasicMatrix<T> &a, const BasicMatrix<T> &b,
+                                          BasicMatrix<T> &out, Accumulate mode, T alpha)
+{
+    const size_t n = a.getRows();
+    if (a.getCols() != n || b.getCols() != n || !hasKernel(n))
+    {
+        this->delegateInto(fallback, a, b, out, mode, alpha);
+        return;
+    }
+
+    this->validateOutput(a, b, out, mode);
+    if (mode == Accumulate::Overwrite)
+    {
+        out.resize(n, n); // the kernel stores every element, no zeroing needed
+    }
+    switch (n)
+    {
+    case 3:
+        multiplyUnrolled<3>(a, b, out, mode, alpha);
+        break;
+    case 4:
+        multiplyUnrolled<4>(a, b, out, mode, alpha);
+        break;
+    case 8:
+        multiplyUnrolled<8>(a, b, out, mode, alpha);
+        break;
+    default:
+        multiplyUnrolled<16>(a, b, out, mode, alpha);
+        break;
+    }
+}
+
+/**
+ * @brief Fixed-size multiplier of double matrices
+ */
+using FixedSizeMultiplier = BasicFixedSizeMultiplier<double>;
+
+template class BasicFixedSizeMultiplier<float>;
+template class BasicFixedSizeMultiplier<double>;
+template class BasicFixedSizeMultiplier<int32_t>;
+template class BasicFixedSizeMultiplier<int64_t>;
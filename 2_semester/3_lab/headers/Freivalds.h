@@ -0,0 +1,179 @@
+#pragma once
+#include "Matrix.h"
+#include "Philox.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Outcome of verifyProduct()
+ */
+struct VerifyResult
+{
+    bool passed;        // no round found a row outside the tolerance
+    double maxResidual; // largest |A(Br) - Cr| of a row relative to its rounding bound, 0 for integers that match
+    size_t rounds;      // number of random vectors tried
+
+    explicit operator bool() const { return passed; }
+};
+
+/**
+ * @brief Checks C = A * B with Freivalds' randomized test in O(n^2) per round
+ *
+ * Each round draws a random vector r and compares A(Br) with Cr, which
+ * needs three matrix-vector products instead of a second multiplication.
+ * For a wrong C a round misses the error with probability at most 1/2, so
+ * rounds rounds leave at most 2^-rounds.
+ *
+ * Floating-point rows are compared against a rounding bound: the residual
+ * of row i is |A(Br) - Cr|_i divided by sum_k |A_ik| sum_j |B_kj| plus
+ * sum_j |C_ij|, and must not exceed tolerance. r holds random signs, which
+ * makes the bound the same in every round and exposes a single wrong
+ * element of C in every round. Integer products are checked exactly, with
+ * r of random 0/1 entries and arithmetic modulo 2^64.
+ *
+ * @param a First factor
+ * @param b Second factor
+ * @param c Claimed product
+ * @param rounds Number of random vectors
+ * @param tolerance Largest relative residual accepted; 0 picks 4 (inner + cols) times the epsilon of R
+ * @param seed Seed of the random vectors
+ * @return VerifyResult - whether C passed, and the largest residual seen
+ * @throw std::invalid_argument if the shapes do not match or rounds is zero
+ */
+template <typename T, typename R>
+VerifyResult verifyProduct(const BasicMatrix<T> &a, const BasicMatrix<T> &b, const BasicMatrix<R> &c,
+                           size_t rounds = 10, double tolerance = 0.0, uint64_t seed = random_device{}())
+{
+    if (a.getCols() != b.getRows() || c.getRows() != a.getRows() || c.getCols() != b.getCols())
+    {
+        throw std::invalid_argument("Matrix dimensions do not match the product");
+    }
+    if (rounds == 0)
+    {
+        throw std::invalid_argument("Number of rounds must be positive");
+    }
+
+    const size_t rows = a.getRows();
+    const size_t inner = a.getCols();
+    const size_t cols = b.getCols();
+    constexpr bool exact = is_integral_v<R>;
+    using V = conditional_t<exact, uint64_t, double>;
+
+    // rounding bound of every row, independent of r because |r_j| = 1
+    vector<double> bound(rows, 0.0);
+    if constexpr (!exact)
+    {
+        if (tolerance == 0.0)
+        {
+            tolerance = 4.0 * double(inner + cols) * double(numeric_limits<R>::epsilon());
+        }
+        vector<double> bRowSums(inner, 0.0);
+        for (size_t k = 0; k < inner; ++k)
+        {
+            const T *bRow = b.rowPtr(k);
+            for (size_t j = 0; j < cols; ++j)
+            {
+                bRowSums[k] += fabs(double(bRow[j]));
+            }
+        }
+        for (size_t i = 0; i < rows; ++i)
+        {
+            const T *aRow = a.rowPtr(i);
+            const R *cRow = c.rowPtr(i);
+            double sum = 0.0;
+            for (size_t k = 0; k < inner; ++k)
+            {
+                sum += fabs(double(aRow[k])) * bRowSums[k];
+            }
+            for (size_t j = 0; j < cols; ++j)
+            {
+                sum += fabs(double(cRow[j]));
+            }
+            bound[i] = sum;
+        }
+    }
+
+    const Philox4x32::Key key = Philox4x32::makeKey(seed);
+    vector<V> r(cols), y(inner);
+    VerifyResult result{true, 0.0, rounds};
+    for (size_t round = 0; round < rounds; ++round)
+    {
+        // one Philox block gives 128 random bits, one per element of r
+        for (size_t j0 = 0; j0 < cols; j0 += 128)
+        {
+            const Philox4x32::Counter bits = Philox4x32::generate(
+                {uint32_t(j0 / 128), uint32_t(j0 / 128 >> 32), uint32_t(round), uint32_t(uint64_t(round) >> 32)},
+                key);
+            for (size_t l = 0; l < 128 && j0 + l < cols; ++l)
+            {
+                const bool bit = (bits[l / 32] >> (l % 32)) & 1;
+                r[j0 + l] = exact ? V(bit) : (bit ? V(1) : V(-1));
+            }
+        }
+
+        for (size_t k = 0; k < inner; ++k)
+        {
+            const T *bRow = b.rowPtr(k);
+            V sum = 0;
+            for (size_t j = 0; j < cols; ++j)
+            {
+                sum += V(bRow[j]) * r[j];
+            }
+            y[k] = sum;
+        }
+
+        for (size_t i = 0; i < rows; ++i)
+        {
+            const T *aRow = a.rowPtr(i);
+            const R *cRow = c.rowPtr(i);
+            V left = 0, right = 0;
+            for (size_t k = 0; k < inner; ++k)
+            {
+                left += V(aRow[k]) * y[k];
+            }
+            for (size_t j = 0; j < cols; ++j)
+            {
+                right += V(cRow[j]) * r[j];
+            }
+
+            if constexpr (exact)
+            {
+                if (left != right)
+                {
+                    result.passed = false;
+                    result.maxResidual = numeric_limits<double>::infinity();
+                    result.rounds = round + 1;
+                    return result;
+                }
+            }
+            else
+            {
+                const double difference = fabs(left - right);
+                const double residual = difference == 0.0 ? 0.0 : difference / bound[i];
+                // written so that NaN fails too
+                if (!(residual <= tolerance))
+                {
+                    result.passed = false;
+                }
+                if (!(residual <= result.maxResidual))
+                {
+                    result.maxResidual = residual;
+                }
+            }
+        }
+        if (!result.passed)
+        {
+            result.rounds = round + 1; // the rows of the failing round are all reported, later rounds are not run
+            break;
+        }
+    }
+    return result;
+}
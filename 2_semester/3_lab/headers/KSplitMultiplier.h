@@ -0,0 +1,279 @@
+#pragma once
+#include "MatrixMultiplier.h"
+#include "ThreadPool.h"
+#include "PerfCounters.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Parallel matrix multiplication that splits the shared (inner) dimension
+ *
+ * Splitting C into row strips leaves most threads idle when A has fewer
+ * rows than there are threads, e.g. the 8 x 1,000,000 times 1,000,000 x 8
+ * products of Gram matrices. Here every part takes a contiguous range of
+ * the shared dimension instead and accumulates A[:, k0..k1] * B[k0..k1, :]
+ * into a private partial C. The partials are then added pairwise in a
+ * fixed tree (0+1, 2+3, ..., then 0+2, ...), so the rounding of the result
+ * depends only on the number of parts, never on which thread finished first.
+ *
+ * Within a part the range is walked in blocks of KBLOCK rows of B, which
+ * stay in cache while every row of A uses them; each block is one tile for
+ * multiplyAsync() progress. suits() tells when the split pays off;
+ * ParallelMultiplier uses it to switch to this strategy on its own.
+ *
+ * With setCounting() enabled every part reads the hardware counters of
+ * the worker running it, including the partials it absorbs in the
+ * reduction, so getPartCounters() breaks the last call down per part.
+ *
+ * @tparam T Element type of the input matrices
+ * @tparam R Accumulation type, also the element type of the result
+ */
+template <typename T, typename R = typename DefaultAccumulator<T>::type>
+class BasicKSplitMultiplier : public BasicMatrixMultiplier<T, R>
+{
+public:
+    static constexpr size_t KBLOCK = 256; // rows of B per cache block (and tile)
+
+private:
+    size_t numThreads;                // number of parts the shared dimension is split into
+    shared_ptr<ThreadPool> pool;      // workers computing the parts
+    vector<BasicMatrix<R>> partials;  // private partial C of every part, reused across calls
+    bool counting;                    // whether parts read the hardware counters of their worker
+    vector<PerfSample> partCounters;  // counters of every part of the last call
+
+    /**
+     * @brief Accumulates A[:, kBegin..kEnd] * B[kBegin..kEnd, :] into a zeroed partial
+     */
+    void multiplyPart(const BasicMatrix<T> &a, const BasicMatrix<T> &b, BasicMatrix<R> &partial,
+                      size_t kBegin, size_t kEnd);
+
+protected:
+    /**
+     * @brief Multiplies two matrices, the shared dimension split across threads, into a caller-owned output
+     * @param a First matrix
+     * @param b Second matrix
+     * @param out Receives (or accumulates) the product
+     * @param mode Overwrite out or add the product to it
+     * @param alpha Scale applied to the product
+     */
+    void compute(const BasicMatrix<T> &a, const BasicMatrix<T> &b, BasicMatrix<R> &out,
+                 Accumulate mode, R alpha) override;
+
+public:
+    /**
+     * @brief Construct a new K-split Multiplier object with its own thread pool
+     * @param numThreads Number of worker threads (and parts)
+     * @throw std::invalid_argument if numThreads is zero
+     */
+    explicit BasicKSplitMultiplier(size_t numThreads = ThreadPool::defaultSize());
+
+    /**
+     * @brief Construct a new K-split Multiplier object running on a shared pool
+     * @param pool Pool to run the parts on, may be shared with other multipliers
+     * @param numThreads Number of parts, 0 means one per pool worker
+     * @throw std::invalid_argument if pool is null
+     */
+    explicit BasicKSplitMultiplier(shared_ptr<ThreadPool> pool, size_t numThreads = 0);
+
+    /**
+     * @brief Checks whether splitting the shared dimension beats splitting the rows
+     *
+     * True when the partial results of all threads together hold no more
+     * elements than the shared dimension is long: the reduction is then
+     * negligible next to the product, and B is read once in total rather
+     * than once per row strip.
+     *
+     * @param rows Rows of A
+     * @param inner Columns of A, rows of B
+     * @param cols Columns of B
+     * @param threads Number of threads available
+     * @return true if the K-split strategy should be used
+     */
+    static bool suits(size_t rows, size_t inner, size_t cols, size_t threads)
+    {
+        return threads > 1 && rows * cols * threads <= inner;
+    }
+
+    /**
+     * @brief Enables or disables hardware counters per part
+     * @param enabled true to measure every part of the next calls
+     */
+    void setCounting(bool enabled) { counting = enabled; }
+
+    /**
+     * @brief Gets the hardware counters of every part of the last call
+     *
+     * Empty if counting is disabled; where perf_event_open is unavailable
+     * the parts have no counters present.
+     *
+     * @return const vector<PerfSample>& - one entry per part
+     */
+    const vector<PerfSample> &getPartCounters() const { return partCounters; }
+
+    /**
+     * @brief Gets the name of the multiplication algorithm
+     * @return const char* - "K-split" as the algorithm identifier
+     */
+    const char *getName() const override { return "K-split"; }
+};
+
+template <typename T, typename R>
+BasicKSplitMultiplier<T, R>::BasicKSplitMultiplier(size_t numThreads) : numThreads(numThreads), counting(false)
+{
+    if (numThreads == 0)
+    {
+        throw std::invalid_argument("Number of threads must be positive");
+    }
+    pool = make_shared<ThreadPool>(numThreads);
+}
+
+template <typename T, typename R>
+BasicKSplitMultiplier<T, R>::BasicKSplitMultiplier(shared_ptr<ThreadPool> pool, size_t numThreads)
+    : numThreads(numThreads), pool(std::move(pool)), counting(false)
+{
+    if (!this->pool)
+    {
+        throw std::invalid_argument("Thread pool must not be null");
+    }
+    if (this->numThreads == 0)
+    {
+        this->numThreads = this->pool->size();
+    }
+}
+
+template <typename T, typename R>
+void BasicKSplitMultiplier<T, R>::multiplyPart(const BasicMatrix<T> &a, const BasicMatrix<T> &b,
+                                               BasicMatrix<R> &partial, size_t kBegin, size_t kEnd)
+{
+    const size_t rows = a.getRows();
+    const size_t cols = b.getCols();
+    for (size_t kk = kBegin; kk < kEnd; kk += KBLOCK)
+    {
+        const size_t kBlockEnd = min(kk + KBLOCK, kEnd);
+        for (size_t i = 0; i < rows; ++i)
+        {
+            const T *aRow = a.rowPtr(i);
+            R *cRow = partial.rowPtr(i);
+            for (size_t k = kk; k < kBlockEnd; ++k)
+            {
+                const R aik = static_cast<R>(aRow[k]);
+                const T *bRow = b.rowPtr(k);
+                for (size_t j = 0; j < cols; ++j)
+                {
+                    cRow[j] += aik * static_cast<R>(bRow[j]);
+                }
+            }
+        }
+        this->finishTile();
+    }
+}
+
+template <typename T, typename R>
+void BasicKSplitMultiplier<T, R>::compute(const BasicMatrix<T> &a, const BasicMatrix<T> &b,
+                                          BasicMatrix<R> &out, Accumulate mode, R alpha)
+{
+    this->validateOutput(a, b, out, mode);
+
+    const size_t rows = a.getRows();
+    const size_t inner = a.getCols();
+    const size_t cols = b.getCols();
+
+    // at least one block per part; the split depends only on the sizes, so results are reproducible
+    const size_t parts = min(numThreads, (inner + KBLOCK - 1) / KBLOCK);
+    while (partials.size() < parts)
+    {
+        partials.emplace_back(0, 0);
+    }
+
+    auto range = [inner, parts](size_t p)
+    {
+        return make_pair(p * inner / parts, (p + 1) * inner / parts);
+    };
+    size_t tiles = 0;
+    for (size_t p = 0; p < parts; ++p)
+    {
+        const auto [kBegin, kEnd] = range(p);
+        tiles += (kEnd - kBegin + KBLOCK - 1) / KBLOCK;
+    }
+    this->startTiles(tiles);
+    partCounters.assign(counting ? parts : 0, PerfSample());
+
+    // every part zeroes and fills its own partial, so the zeroing runs in parallel too
+    vector<future<void>> tasks;
+    for (size_t p = 0; p < parts; ++p)
+    {
+        tasks.push_back(pool->submit([this, &a, &b, &range, p, rows, cols]
+                                     {
+            const PerfSample before = counting ? PerfCounters::forThisThread().read() : PerfSample();
+            BasicMatrix<R> &partial = partials[p];
+            partial.resize(rows, cols);
+            for (size_t i = 0; i < rows; ++i)
+            {
+                memset(partial.rowPtr(i), 0, cols * sizeof(R));
+            }
+            const auto [kBegin, kEnd] = range(p);
+            multiplyPart(a, b, partial, kBegin, kEnd);
+            if (counting)
+            {
+                partCounters[p] = PerfCounters::forThisThread().read() - before;
+            } }));
+    }
+    ThreadPool::waitAll(tasks);
+
+    // fixed pairwise tree: level by level, partial p absorbs partial p + step
+    for (size_t step = 1; step < parts; step *= 2)
+    {
+        tasks.clear();
+        for (size_t p = 0; p + step < parts; p += 2 * step)
+        {
+            // within a level every part absorbs at most once, so each entry of partCounters has one writer
+            tasks.push_back(pool->submit([this, p, step, rows, cols]
+                                         {
+                const PerfSample before = counting ? PerfCounters::forThisThread().read() : PerfSample();
+                for (size_t i = 0; i < rows; ++i)
+                {
+                    R *dst = partials[p].rowPtr(i);
+                    const R *src = partials[p + step].rowPtr(i);
+                    for (size_t j = 0; j < cols; ++j)
+                    {
+                        dst[j] += src[j];
+                    }
+                }
+                if (counting)
+                {
+                    partCounters[p] += PerfCounters::forThisThread().read() - before;
+                } }));
+        }
+        ThreadPool::waitAll(tasks);
+    }
+
+    if (mode == Accumulate::Overwrite)
+    {
+        out.resize(rows, cols); // every element is written below, no zeroing needed
+    }
+    for (size_t i = 0; i < rows; ++i)
+    {
+        const R *src = partials[0].rowPtr(i);
+        R *dst = out.rowPtr(i);
+        for (size_t j = 0; j < cols; ++j)
+        {
+            dst[j] = mode == Accumulate::Add ? dst[j] + alpha * src[j] : alpha * src[j];
+        }
+    }
+}
+
+/**
+ * @brief K-split multiplier of double matrices
+ */
+using KSplitMultiplier = BasicKSplitMultiplier<double>;
+
+template class BasicKSplitMultiplier<float>;
+template class BasicKSplitMultiplier<double>;
+template class BasicKSplitMultiplier<int32_t>;
+template class BasicKSplitMultiplier<int64_t>;
+template class BasicKSplitMultiplier<int8_t, int32_t>;
+template class BasicKSplitMultiplier<int16_t, int32_t>;
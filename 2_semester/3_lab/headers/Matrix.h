@@ -1,40 +1,169 @@
 #pragma once
 #include <vector>
+#include <algorithm>
 #include <iostream>
 #include <random>
 #include <iomanip>
 #include <stdexcept>
+#include <cstring>
+#include <new>
+#include <cstdint>
+#include <type_traits>
+#include <memory>
+#include <string>
+#include <thread>
+#include "MatrixFile.h"
+#include "Philox.h"
 
 using namespace std;
 
+template <typename E>
+class MatrixExpr;
+
 /**
  * @brief A class representing a 2D matrix with basic operations
  *
- * This class implements a matrix using a 2D vector and provides basic
- * matrix operations including construction, element access, and multiplication checks.
- * The class is designed to work with both sequential and parallel multiplication algorithms.
+ * @tparam T Element type; instantiated for float, double and the
+ * int8/int16/int32/int64 integer types. Matrix is the double version.
+ *
+ * The elements are stored row-major in a single 64-byte aligned buffer.
+ * Every row starts on an aligned address: the distance between two rows
+ * (the leading dimension, see getStride()) is the number of columns rounded
+ * up to a whole cache line. Raw access through data() and rowPtr() is meant
+ * for blocked and vectorized kernels, while at() stays the simple interface.
+ * A matrix can also be saved to and mapped from a binary file (see
+ * MatrixFileHeader); a mapped matrix reads its elements straight from the
+ * page cache without copying. Batches of small matrices can share one
+ * contiguous arena (see makeBatch()).
+ * Arithmetic (+, -, scalar * and the product) is available through the
+ * expression templates in MatrixExpression.h.
  */
-class Matrix
+template <typename T>
+class BasicMatrix
 {
+public:
+    static constexpr size_t ALIGNMENT = 64; // alignment of the buffer and of every row, in bytes
+
 private:
-    vector<vector<double>> data; // The 2D vector storing matrix elements
-    size_t rows;                 // Number of rows in the matrix
-    size_t cols;                 // Number of columns in the matrix
+    size_t rows;            // Number of rows in the matrix
+    size_t cols;            // Number of columns in the matrix
+    size_t stride;          // Distance between the starts of two rows, in elements
+    T *buffer;              // Aligned row-major storage of rows * stride elements
+    size_t capacity;        // Elements the buffer can hold, at least rows * stride
+    shared_ptr<void> owner; // Mapped file or batch arena the buffer points into, null for own heap storage
+    bool mapped;            // Whether owner is a mapped file
+
+    /**
+     * @brief Allocates an aligned buffer
+     * @param count Number of elements
+     * @return T* - pointer to the buffer, nullptr if count is zero
+     */
+    static T *allocate(size_t count);
+
+    /**
+     * @brief Releases a buffer obtained from allocate()
+     * @param ptr Buffer to release
+     */
+    static void deallocate(T *ptr);
+
+    /**
+     * @brief Releases the storage, whether it is heap memory, a mapping or a share of an arena
+     */
+    void release();
+
+    /**
+     * @brief Fills columns of one row with the counter-based random values of randomize(seed)
+     * @param row Pointer to element (i,0)
+     * @param i Row index, part of the counter
+     * @param cols Number of elements to fill
+     * @param key Philox key made from the seed
+     */
+    static void randomizeRow(T *row, size_t i, size_t cols, Philox4x32::Key key);
+
+    /**
+     * @brief Wraps elements that live inside a mapped file or an arena
+     */
+    BasicMatrix(size_t rows, size_t cols, size_t stride, T *buffer, shared_ptr<void> owner, bool mapped);
 
 public:
     /**
-     * @brief Construct a new Matrix object
+     * @brief Construct a new Matrix object filled with zeros
      * @param rows Number of rows in the matrix
      * @param cols Number of columns in the matrix
      */
-    Matrix(size_t rows, size_t cols);
+    BasicMatrix(size_t rows, size_t cols);
 
     /**
      * @brief Construct a new Matrix object
      *
-     * @param data
+     * @param data Rows of the matrix, all of the same length
+     * @throw std::invalid_argument if the rows have different lengths
+     */
+    BasicMatrix(const vector<vector<T>> &data);
+
+    /**
+     * @brief Copies the matrix into a new buffer
+     * @param other Matrix to copy
+     */
+    BasicMatrix(const BasicMatrix &other);
+
+    /**
+     * @brief Takes over the buffer of another matrix, leaving it empty (0x0)
+     * @param other Matrix to move from
+     */
+    BasicMatrix(BasicMatrix &&other) noexcept;
+
+    /**
+     * @brief Replaces the contents with a copy of another matrix, reusing the storage if it is large enough
+     * @param other Matrix to copy
+     * @return BasicMatrix& - this matrix
      */
-    Matrix(const vector<vector<double>> &data);
+    BasicMatrix &operator=(const BasicMatrix &other);
+
+    /**
+     * @brief Replaces the contents with the buffer of another matrix
+     * @param other Matrix to move from, left empty (0x0)
+     * @return BasicMatrix& - this matrix
+     */
+    BasicMatrix &operator=(BasicMatrix &&other) noexcept;
+
+    /**
+     * @brief Evaluates a matrix expression into a new matrix
+     * @param expr Expression built with the operators of MatrixExpression.h
+     */
+    template <typename E>
+    BasicMatrix(const MatrixExpr<E> &expr);
+
+    /**
+     * @brief Evaluates a matrix expression in one fused pass, reusing the buffer when the shape matches
+     * @param expr Expression built with the operators of MatrixExpression.h
+     * @return BasicMatrix& - this matrix
+     */
+    template <typename E>
+    BasicMatrix &operator=(const MatrixExpr<E> &expr);
+
+    /**
+     * @brief Adds a matrix expression to this matrix in place
+     * @param expr Expression of the same shape
+     * @return BasicMatrix& - this matrix
+     * @throw std::invalid_argument if the shapes differ
+     */
+    template <typename E>
+    BasicMatrix &operator+=(const MatrixExpr<E> &expr);
+
+    /**
+     * @brief Subtracts a matrix expression from this matrix in place
+     * @param expr Expression of the same shape
+     * @return BasicMatrix& - this matrix
+     * @throw std::invalid_argument if the shapes differ
+     */
+    template <typename E>
+    BasicMatrix &operator-=(const MatrixExpr<E> &expr);
+
+    /**
+     * @brief Releases the buffer
+     */
+    ~BasicMatrix();
 
     /**
      * @brief Gets the number of rows in the matrix
@@ -48,98 +177,537 @@ public:
      */
     size_t getCols() const { return cols; }
 
+    /**
+     * @brief Gets the leading dimension (distance between rows) of the buffer
+     * @return size_t - row stride in elements, always >= getCols()
+     */
+    size_t getStride() const { return stride; }
+
+    /**
+     * @brief Gets the number of elements the storage can hold without reallocating
+     * @return size_t - capacity in elements, see resize()
+     */
+    size_t getCapacity() const { return capacity; }
+
+    /**
+     * @brief Changes the shape, reusing the storage when it is large enough
+     *
+     * Nothing happens if the shape does not change. Otherwise the matrix is
+     * zero-filled in the new shape; the buffer is kept whenever rows times
+     * the padded stride fits in getCapacity(), so a matrix that is resized
+     * back and forth between shapes allocates only for the largest one. A
+     * mapped matrix is detached from its file and gets heap storage.
+     *
+     * @param rows New number of rows
+     * @param cols New number of columns
+     */
+    void resize(size_t rows, size_t cols);
+
+    /**
+     * @brief Rounds the column count up to a whole number of cache lines
+     * @param cols Number of columns
+     * @return size_t - stride of a freshly allocated (or saved) matrix with that many columns
+     */
+    static size_t paddedStride(size_t cols);
+
     /**
      * @brief Accesses matrix element at specified position
      * @param i Row index (0-based)
      * @param j Column index (0-based)
      * @return Reference to the element at position (i,j)
-     * @throw std::out_of_range if indices are out of bounds
      */
-    double &at(size_t i, size_t j) { return data[i][j]; }
+    T &at(size_t i, size_t j) { return buffer[i * stride + j]; }
 
     /**
      * @brief Accesses matrix element at specified position (const version)
      * @param i Row index (0-based)
      * @param j Column index (0-based)
-     * @return const double&
+     * @return const T&
+     */
+    const T &at(size_t i, size_t j) const { return buffer[i * stride + j]; }
+
+    /**
+     * @brief Gets the raw storage of the matrix
+     * @return T* - pointer to element (0,0), aligned to ALIGNMENT
      */
-    const double &at(size_t i, size_t j) const { return data[i][j]; }
+    T *data() { return buffer; }
+    const T *data() const { return buffer; }
 
     /**
-     * @brief Fills the matrix with random values between 0 and 1
+     * @brief Gets a pointer to the beginning of a row
+     * @param i Row index (0-based)
+     * @return T* - pointer to element (i,0), aligned to ALIGNMENT
+     */
+    T *rowPtr(size_t i) { return buffer + i * stride; }
+    const T *rowPtr(size_t i) const { return buffer + i * stride; }
+
+    /**
+     * @brief Fills the matrix with random values: [0, 1) for floating-point
+     * types, integers 0..9 for integer types
+     *
+     * The seed is taken from std::random_device, so every call gives a new
+     * matrix; use randomize(seed) to reproduce one.
      */
     void randomize();
 
+    /**
+     * @brief Fills the matrix with reproducible random values in parallel
+     *
+     * Element (i,j) is computed by Philox4x32 from (seed, i, j) alone, so
+     * the rows can be filled by any number of threads in any order and the
+     * same seed always gives the same matrix. The value ranges are those of
+     * randomize().
+     *
+     * @param seed Selects the matrix
+     * @param threads Maximum number of threads; one per core by default, small matrices use fewer
+     * @throw std::invalid_argument if threads is zero
+     */
+    void randomize(uint64_t seed, size_t threads = max<size_t>(1, thread::hardware_concurrency()));
+
     /**
      * @brief Prints the matrix to standard output
      */
     void print() const;
 
     /**
-     * @brief Checks if two matrices can be multiplied
-     * @param a First matrix
-     * @param b Second matrix
-     * @return true if matrices can be multiplied (a.cols == b.rows), false otherwise
+     * @brief Checks whether the elements live in a mapped file
+     * @return true for matrices returned by mapFile()
+     */
+    bool isMapped() const { return mapped; }
+
+    /**
+     * @brief Writes the matrix to a binary file: a MatrixFileHeader followed by the rows
+     * @param path Output file, overwritten if it exists
+     * @throw std::runtime_error if the file cannot be written
      */
-    static bool canMultiply(const Matrix &a, const Matrix &b);
+    void save(const string &path) const;
 
     /**
-     * @brief Stream insertion operator for Matrix
+     * @brief Opens a binary matrix file without reading it
+     *
+     * The file is memory-mapped, so this is O(1) regardless of its size and
+     * pages are loaded lazily on first access. Copies of the result are
+     * ordinary in-memory matrices.
+     *
+     * @param path File written by save() or by an upstream job in the same format
+     * @param writeBack true to write modifications back to the file,
+     *                  false to keep them private to this process
+     * @return BasicMatrix - matrix backed by the mapping
+     * @throw std::runtime_error if the file is missing, truncated, of another element type
+     * or its rows are not aligned to ALIGNMENT
+     */
+    static BasicMatrix mapFile(const string &path, bool writeBack = false);
+
+    /**
+     * @brief Creates zero-filled matrices of one shape stored back to back in a single arena
+     *
+     * One aligned allocation serves the whole batch, so creating many small
+     * matrices costs one allocator call and the batch is contiguous in
+     * memory. The arena is freed when the last of the matrices is destroyed;
+     * copies of the matrices get their own storage.
      *
-     * @param os
-     * @param matrix
-     * @return ostream&
+     * @param count Number of matrices
+     * @param rows Number of rows of every matrix
+     * @param cols Number of columns of every matrix
+     * @return vector<BasicMatrix> - the matrices
      */
-    friend ostream &operator<<(ostream &os, const Matrix &matrix);
+    static vector<BasicMatrix> makeBatch(size_t count, size_t rows, size_t cols);
+
+    /**
+     * @brief Creates a matrix whose elements (and padding) are not written yet
+     *
+     * The operating system places a page on the NUMA node of the thread that
+     * first writes it. A matrix made here can be zero-filled or computed by
+     * the threads that will later use each part of it, instead of having
+     * all of its pages land on the node of the constructing thread. Every
+     * element must be written before it is read.
+     *
+     * @param rows Number of rows
+     * @param cols Number of columns
+     * @return BasicMatrix - matrix with indeterminate elements
+     */
+    static BasicMatrix makeUninitialized(size_t rows, size_t cols);
+
+    /**
+     * @brief Checks if two matrices can be multiplied
+     * @param a First matrix
+     * @param b Second matrix
+     * @return true if matrices can be multiplied (a.cols == b.rows), false otherwise
+     */
+    static bool canMultiply(const BasicMatrix &a, const BasicMatrix &b);
 };
 
-Matrix::Matrix(size_t rows, size_t cols)
-    : rows(rows), cols(cols), data(rows, vector<double>(cols, 0.0)) {}
+/**
+ * @brief Matrix of doubles, the type used by most of the multipliers
+ */
+using Matrix = BasicMatrix<double>;
+
+/**
+ * @brief Stream insertion operator for Matrix
+ *
+ * @param os
+ * @param matrix
+ * @return ostream&
+ */
+template <typename T>
+ostream &operator<<(ostream &os, const BasicMatrix<T> &matrix);
 
-Matrix::Matrix(const vector<vector<double>> &data)
-    : data(data), rows(data.size()), cols(data[0].size()) {}
+template <typename T>
+size_t BasicMatrix<T>::paddedStride(size_t cols)
+{
+    const size_t perLine = ALIGNMENT / sizeof(T);
+    return (cols + perLine - 1) / perLine * perLine;
+}
 
-void Matrix::randomize()
+template <typename T>
+T *BasicMatrix<T>::allocate(size_t count)
 {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> dis(0.0, 1.0);
+    if (count == 0)
+    {
+        return nullptr;
+    }
+    return static_cast<T *>(::operator new(count * sizeof(T), align_val_t(ALIGNMENT)));
+}
 
+template <typename T>
+void BasicMatrix<T>::deallocate(T *ptr)
+{
+    if (ptr)
+    {
+        ::operator delete(ptr, align_val_t(ALIGNMENT));
+    }
+}
+
+template <typename T>
+BasicMatrix<T>::BasicMatrix(size_t rows, size_t cols)
+    : rows(rows), cols(cols), stride(paddedStride(cols)), buffer(allocate(rows * stride)), capacity(rows * stride),
+      mapped(false)
+{
+    if (buffer)
+    {
+        memset(buffer, 0, rows * stride * sizeof(T));
+    }
+}
+
+template <typename T>
+BasicMatrix<T>::BasicMatrix(size_t rows, size_t cols, size_t stride, T *buffer, shared_ptr<void> owner, bool mapped)
+    : rows(rows), cols(cols), stride(stride), buffer(buffer), capacity(rows * stride), owner(std::move(owner)),
+      mapped(mapped) {}
+
+template <typename T>
+BasicMatrix<T>::BasicMatrix(const vector<vector<T>> &data)
+    : BasicMatrix(data.size(), data.empty() ? 0 : data[0].size())
+{
     for (size_t i = 0; i < rows; ++i)
     {
-        for (size_t j = 0; j < cols; ++j)
+        if (data[i].size() != cols)
+        {
+            // the delegated constructor has finished, so the destructor frees the buffer
+            throw std::invalid_argument("All matrix rows must have the same length");
+        }
+        copy(data[i].begin(), data[i].end(), rowPtr(i));
+    }
+}
+
+template <typename T>
+BasicMatrix<T>::BasicMatrix(const BasicMatrix &other)
+    : rows(other.rows), cols(other.cols), stride(paddedStride(other.cols)), buffer(allocate(rows * stride)),
+      capacity(rows * stride), mapped(false)
+{
+    // a mapped source may use another stride, so rows are copied one by one
+    for (size_t i = 0; i < rows; ++i)
+    {
+        memcpy(rowPtr(i), other.rowPtr(i), cols * sizeof(T));
+        memset(rowPtr(i) + cols, 0, (stride - cols) * sizeof(T));
+    }
+}
+
+template <typename T>
+BasicMatrix<T>::BasicMatrix(BasicMatrix &&other) noexcept
+    : rows(other.rows), cols(other.cols), stride(other.stride), buffer(other.buffer), capacity(other.capacity),
+      owner(std::move(other.owner)), mapped(other.mapped)
+{
+    other.rows = other.cols = other.stride = other.capacity = 0;
+    other.buffer = nullptr;
+    other.mapped = false;
+}
+
+template <typename T>
+BasicMatrix<T> &BasicMatrix<T>::operator=(const BasicMatrix &other)
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+    if (mapped || other.rows * paddedStride(other.cols) > capacity)
+    {
+        BasicMatrix tmp(other);
+        *this = std::move(tmp);
+        return *this;
+    }
+
+    // the buffer is large enough: copy in place instead of allocating
+    rows = other.rows;
+    cols = other.cols;
+    stride = paddedStride(cols);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        memcpy(rowPtr(i), other.rowPtr(i), cols * sizeof(T));
+        memset(rowPtr(i) + cols, 0, (stride - cols) * sizeof(T));
+    }
+    return *this;
+}
+
+template <typename T>
+BasicMatrix<T> &BasicMatrix<T>::operator=(BasicMatrix &&other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        rows = other.rows;
+        cols = other.cols;
+        stride = other.stride;
+        buffer = other.buffer;
+        capacity = other.capacity;
+        owner = std::move(other.owner);
+        mapped = other.mapped;
+        other.rows = other.cols = other.stride = other.capacity = 0;
+        other.buffer = nullptr;
+        other.mapped = false;
+    }
+    return *this;
+}
+
+template <typename T>
+BasicMatrix<T>::~BasicMatrix()
+{
+    release();
+}
+
+template <typename T>
+void BasicMatrix<T>::release()
+{
+    if (owner)
+    {
+        owner.reset(); // the file is unmapped (the arena freed) when its last matrix goes away
+    }
+    else
+    {
+        deallocate(buffer);
+    }
+    buffer = nullptr;
+    capacity = 0;
+    mapped = false;
+}
+
+template <typename T>
+void BasicMatrix<T>::resize(size_t rows, size_t cols)
+{
+    if (rows == this->rows && cols == this->cols)
+    {
+        return;
+    }
+
+    const size_t newStride = paddedStride(cols);
+    if (mapped || rows * newStride > capacity)
+    {
+        *this = BasicMatrix(rows, cols);
+        return;
+    }
+
+    // heap storage or an arena slice that is large enough: only the shape changes
+    this->rows = rows;
+    this->cols = cols;
+    stride = newStride;
+    if (buffer)
+    {
+        memset(buffer, 0, rows * stride * sizeof(T));
+    }
+}
+
+template <typename T>
+void BasicMatrix<T>::randomize()
+{
+    std::random_device rd;
+    randomize((uint64_t(rd()) << 32) | rd());
+}
+
+template <typename T>
+void BasicMatrix<T>::randomizeRow(T *row, size_t i, size_t cols, Philox4x32::Key key)
+{
+    // one Philox block yields four 32-bit words: two doubles or four smaller elements
+    constexpr size_t perBlock = is_same_v<T, double> ? 2 : 4;
+
+    for (size_t j0 = 0; j0 < cols; j0 += perBlock)
+    {
+        const uint64_t block = j0 / perBlock;
+        const Philox4x32::Counter bits = Philox4x32::generate(
+            {uint32_t(block), uint32_t(block >> 32), uint32_t(i), uint32_t(uint64_t(i) >> 32)}, key);
+        const size_t count = min(perBlock, cols - j0);
+        for (size_t l = 0; l < count; ++l)
         {
-            data[i][j] = dis(gen);
+            if constexpr (is_same_v<T, double>)
+            {
+                row[j0 + l] = Philox4x32::toUnitDouble(bits[2 * l], bits[2 * l + 1]);
+            }
+            else if constexpr (is_floating_point_v<T>)
+            {
+                row[j0 + l] = static_cast<T>(Philox4x32::toUnitFloat(bits[l]));
+            }
+            else
+            {
+                // small values keep integer products far from overflow
+                row[j0 + l] = static_cast<T>(Philox4x32::toRange(bits[l], 10));
+            }
         }
     }
 }
 
-void Matrix::print() const
+template <typename T>
+void BasicMatrix<T>::randomize(uint64_t seed, size_t threads)
 {
+    if (threads == 0)
+    {
+        throw std::invalid_argument("Number of threads must be positive");
+    }
+
+    // a thread is only worth starting for a few pages of elements
+    constexpr size_t MIN_ELEMENTS_PER_THREAD = size_t(1) << 16;
+    threads = min({threads, rows, max<size_t>(1, rows * cols / MIN_ELEMENTS_PER_THREAD)});
+
+    const Philox4x32::Key key = Philox4x32::makeKey(seed);
+    auto fillRows = [this, key](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            randomizeRow(rowPtr(i), i, cols, key);
+        }
+    };
+
+    if (threads <= 1)
+    {
+        fillRows(0, rows);
+        return;
+    }
+
+    vector<thread> workers;
+    workers.reserve(threads - 1);
+    for (size_t t = 1; t < threads; ++t)
+    {
+        workers.emplace_back(fillRows, rows * t / threads, rows * (t + 1) / threads);
+    }
+    fillRows(0, rows / threads); // the calling thread takes the first strip
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+template <typename T>
+void BasicMatrix<T>::print() const
+{
+    cout << *this;
+}
+
+template <typename T>
+void BasicMatrix<T>::save(const string &path) const
+{
+    const MatrixFileHeader header = MatrixFileHeader::describe<T>(rows, cols, paddedStride(cols), ALIGNMENT);
+
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out)
+    {
+        throw std::runtime_error("Cannot create matrix file " + path);
+    }
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    // rows are written with the padding of a freshly allocated matrix, so mapped rows stay aligned
+    const vector<T> padding(header.stride - cols, T(0));
     for (size_t i = 0; i < rows; ++i)
     {
-        for (size_t j = 0; j < cols; ++j)
+        out.write(reinterpret_cast<const char *>(rowPtr(i)), cols * sizeof(T));
+        out.write(reinterpret_cast<const char *>(padding.data()), padding.size() * sizeof(T));
+    }
+    if (!out)
+    {
+        throw std::runtime_error("Cannot write matrix file " + path);
+    }
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::mapFile(const string &path, bool writeBack)
+{
+    auto file = make_shared<MappedFile>(path, writeBack);
+    if (file->size() < sizeof(MatrixFileHeader))
+    {
+        throw std::runtime_error("Matrix file is too short: " + path);
+    }
+
+    MatrixFileHeader header;
+    memcpy(&header, file->data(), sizeof(header));
+    header.validate<T>(file->size(), path, ALIGNMENT); // the kernels rely on aligned rows
+
+    T *elements = reinterpret_cast<T *>(static_cast<char *>(file->data()) + header.dataOffset);
+    return BasicMatrix(header.rows, header.cols, header.stride, elements, std::move(file), true);
+}
+
+template <typename T>
+vector<BasicMatrix<T>> BasicMatrix<T>::makeBatch(size_t count, size_t rows, size_t cols)
+{
+    const size_t stride = paddedStride(cols);
+    const size_t elements = rows * stride; // a multiple of a cache line, so every matrix stays aligned
+
+    vector<BasicMatrix> batch;
+    batch.reserve(count);
+    if (count == 0 || elements == 0)
+    {
+        for (size_t i = 0; i < count; ++i)
         {
-            cout << fixed << setprecision(2) << data[i][j] << " ";
+            batch.emplace_back(rows, cols);
         }
-        cout << "\n";
+        return batch;
+    }
+
+    shared_ptr<T> arena(allocate(count * elements), &BasicMatrix::deallocate);
+    memset(arena.get(), 0, count * elements * sizeof(T));
+    for (size_t i = 0; i < count; ++i)
+    {
+        batch.push_back(BasicMatrix(rows, cols, stride, arena.get() + i * elements, arena, false));
     }
+    return batch;
 }
 
-bool Matrix::canMultiply(const Matrix &a, const Matrix &b)
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::makeUninitialized(size_t rows, size_t cols)
+{
+    const size_t stride = paddedStride(cols);
+    return BasicMatrix(rows, cols, stride, allocate(rows * stride), nullptr, false);
+}
+
+template <typename T>
+bool BasicMatrix<T>::canMultiply(const BasicMatrix &a, const BasicMatrix &b)
 {
     return a.getCols() == b.getRows();
 }
 
-ostream &operator<<(ostream &os, const Matrix &matrix)
+template <typename T>
+ostream &operator<<(ostream &os, const BasicMatrix<T> &matrix)
 {
-    for (size_t i = 0; i < matrix.rows; ++i)
+    for (size_t i = 0; i < matrix.getRows(); ++i)
     {
-        for (size_t j = 0; j < matrix.cols; ++j)
+        for (size_t j = 0; j < matrix.getCols(); ++j)
         {
-            os << fixed << setprecision(2) << matrix.data[i][j] << " ";
+            // unary + prints int8_t as a number rather than a character
+            os << fixed << setprecision(2) << +matrix.at(i, j) << " ";
         }
         os << "\n";
     }
     return os;
-}
\ No newline at end of file
+}
+
+template class BasicMatrix<float>;
+template class BasicMatrix<double>;
+template class BasicMatrix<int8_t>;
+template class BasicMatrix<int16_t>;
+template class BasicMatrix<int32_t>;
+template class BasicMatrix<int64_t>;
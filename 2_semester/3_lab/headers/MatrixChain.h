@@ -0,0 +1,438 @@
+#pragma once
+#include "MatrixMultiplier.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Product of a chain of matrices M0 * M1 * ... * Mn-1, evaluated in the cheapest order
+ *
+ * Matrix multiplication is associative, but the cost of a chain depends a
+ * lot on where the parentheses go: (10x1000 * 1000x10) * 10x1000 needs
+ * 200,000 multiplications, 10x1000 * (1000x10 * 10x1000) twenty million.
+ * The constructor runs the classic O(n^3) dynamic program over all
+ * sub-chains to find the parenthesisation with the fewest scalar
+ * multiplications and turns it into a list of steps, each multiplying two
+ * operands or earlier results.
+ *
+ * evaluate() executes the steps with the given multiplier. Given several
+ * multipliers, independent sub-products - steps in different branches of
+ * the plan - run concurrently, one per multiplier; every multiplier is used
+ * by one thread at a time. Intermediate results live in buffers that are
+ * handed back as soon as the step consuming them is done and are kept by
+ * the chain, so later steps and later evaluations reuse their storage.
+ *
+ * The operands are referenced, not copied, and must outlive the chain.
+ *
+ * @tparam T Element type of the matrices
+ */
+template <typename T>
+class BasicMatrixChain
+{
+private:
+    /**
+     * @brief One product of the plan; operand ids below size() are inputs, size() + s is step s
+     */
+    struct Step
+    {
+        size_t left;   // id of the left operand
+        size_t right;  // id of the right operand
+        size_t rows;   // shape of the result
+        size_t cols;
+        size_t parent; // step consuming the result, unused for the root
+    };
+
+    vector<const BasicMatrix<T> *> operands;    // the chain, referenced
+    vector<Step> steps;                         // the plan, children before parents; the last is the root
+    double cost;                                // scalar multiplications of the plan
+    string order;                               // parenthesised form of the plan
+    vector<unique_ptr<BasicMatrix<T>>> buffers; // intermediate results, kept across evaluations
+
+    /**
+     * @brief Finds the cheapest parenthesisation and builds the steps
+     * @throw std::invalid_argument if the chain is empty, a matrix is empty or neighbours do not fit
+     */
+    void plan();
+
+    /**
+     * @brief Appends the steps of sub-chain [i, j] to the plan
+     * @return size_t - id of the sub-chain's result
+     */
+    size_t build(const vector<vector<size_t>> &split, size_t i, size_t j);
+
+public:
+    /**
+     * @brief Construct a new Matrix Chain object over the matrices of a vector
+     * @param operands Matrices in multiplication order, referenced
+     * @throw std::invalid_argument if the chain is empty, a matrix is empty or neighbours do not fit
+     */
+    explicit BasicMatrixChain(const vector<BasicMatrix<T>> &operands);
+
+    /**
+     * @brief Construct a new Matrix Chain object over the pointed-to matrices
+     * @param operands Matrices in multiplication order
+     * @throw std::invalid_argument if the chain is empty, holds a null pointer, a matrix is
+     * empty or neighbours do not fit
+     */
+    explicit BasicMatrixChain(vector<const BasicMatrix<T> *> operands);
+
+    /**
+     * @brief Construct a new Matrix Chain object over the listed matrices, e.g. MatrixChain({&a, &b, &c})
+     * @param operands Matrices in multiplication order
+     * @throw std::invalid_argument if the chain is empty, holds a null pointer, a matrix is
+     * empty or neighbours do not fit
+     */
+    BasicMatrixChain(initializer_list<const BasicMatrix<T> *> operands)
+        : BasicMatrixChain(vector<const BasicMatrix<T> *>(operands)) {}
+
+    /**
+     * @brief Gets the number of matrices in the chain
+     */
+    size_t size() const { return operands.size(); }
+
+    /**
+     * @brief Gets the number of scalar multiplications of the chosen order
+     */
+    double getCost() const { return cost; }
+
+    /**
+     * @brief Gets the number of scalar multiplications of plain left-to-right evaluation
+     */
+    double getNaiveCost() const;
+
+    /**
+     * @brief Gets the chosen order
+     * @return string - e.g. "((M0 M1) M2)"
+     */
+    const string &getOrder() const { return order; }
+
+    /**
+     * @brief Gets the number of intermediate buffers kept for reuse
+     */
+    size_t getBufferCount() const { return buffers.size(); }
+
+    /**
+     * @brief Computes the product into a caller-owned output
+     * @param multipliers One or more strategies; with several, independent steps run concurrently
+     * @param out Receives the product, must not share storage with an operand
+     * @throw std::invalid_argument if no multiplier is given or one is null
+     */
+    void evaluateInto(const vector<BasicMatrixMultiplier<T, T> *> &multipliers, BasicMatrix<T> &out);
+
+    /**
+     * @brief Computes the product into a caller-owned output, one step after another
+     * @param multiplier Strategy computing every step
+     * @param out Receives the product, must not share storage with an operand
+     */
+    void evaluateInto(BasicMatrixMultiplier<T, T> &multiplier, BasicMatrix<T> &out)
+    {
+        evaluateInto(vector<BasicMatrixMultiplier<T, T> *>{&multiplier}, out);
+    }
+
+    /**
+     * @brief Computes the product
+     * @param multipliers One or more strategies; with several, independent steps run concurrently
+     * @return BasicMatrix<T> - M0 * M1 * ... * Mn-1
+     */
+    BasicMatrix<T> evaluate(const vector<BasicMatrixMultiplier<T, T> *> &multipliers);
+
+    /**
+     * @brief Computes the product, one step after another
+     * @param multiplier Strategy computing every step
+     * @return BasicMatrix<T> - M0 * M1 * ... * Mn-1
+     */
+    BasicMatrix<T> evaluate(BasicMatrixMultiplier<T, T> &multiplier)
+    {
+        return evaluate(vector<BasicMatrixMultiplier<T, T> *>{&multiplier});
+    }
+};
+
+template <typename T>
+BasicMatrixChain<T>::BasicMatrixChain(const vector<BasicMatrix<T>> &operands)
+{
+    for (const auto &m : operands)
+    {
+        this->operands.push_back(&m);
+    }
+    plan();
+}
+
+template <typename T>
+BasicMatrixChain<T>::BasicMatrixChain(vector<const BasicMatrix<T> *> operands)
+    : operands(std::move(operands))
+{
+    for (const auto *m : this->operands)
+    {
+        if (!m)
+        {
+            throw std::invalid_argument("Matrix chain operand must not be null");
+        }
+    }
+    plan();
+}
+
+template <typename T>
+void BasicMatrixChain<T>::plan()
+{
+    const size_t n = operands.size();
+    if (n == 0)
+    {
+        throw std::invalid_argument("Matrix chain must not be empty");
+    }
+
+    // dims[i] x dims[i + 1] is the shape of operand i
+    vector<double> dims(n + 1);
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (operands[i]->getRows() == 0 || operands[i]->getCols() == 0)
+        {
+            throw std::invalid_argument("Cannot multiply empty matrices");
+        }
+        if (i > 0 && operands[i - 1]->getCols() != operands[i]->getRows())
+        {
+            throw std::invalid_argument("Matrix dimensions are not compatible for multiplication");
+        }
+        dims[i] = static_cast<double>(operands[i]->getRows());
+    }
+    dims[n] = static_cast<double>(operands[n - 1]->getCols());
+
+    // best[i][j]: cheapest cost of the sub-chain i..j, split[i][j]: last operand of its left half
+    vector<vector<double>> best(n, vector<double>(n, 0.0));
+    vector<vector<size_t>> split(n, vector<size_t>(n, 0));
+    for (size_t length = 2; length <= n; ++length)
+    {
+        for (size_t i = 0; i + length <= n; ++i)
+        {
+            const size_t j = i + length - 1;
+            best[i][j] = numeric_limits<double>::infinity();
+            for (size_t k = i; k < j; ++k)
+            {
+                const double candidate = best[i][k] + best[k + 1][j] + dims[i] * dims[k + 1] * dims[j + 1];
+                if (candidate < best[i][j])
+                {
+                    best[i][j] = candidate;
+                    split[i][j] = k;
+                }
+            }
+        }
+    }
+    cost = best[0][n - 1];
+
+    steps.clear();
+    order.clear();
+    build(split, 0, n - 1);
+}
+
+template <typename T>
+size_t BasicMatrixChain<T>::build(const vector<vector<size_t>> &split, size_t i, size_t j)
+{
+    const size_t n = operands.size();
+    if (i == j)
+    {
+        order += "M" + to_string(i);
+        return i;
+    }
+
+    order += "(";
+    const size_t left = build(split, i, split[i][j]);
+    order += " ";
+    const size_t right = build(split, split[i][j] + 1, j);
+    order += ")";
+
+    const size_t s = steps.size();
+    steps.push_back({left, right, operands[i]->getRows(), operands[j]->getCols(), 0});
+    for (size_t child : {left, right})
+    {
+        if (child >= n)
+        {
+            steps[child - n].parent = s;
+        }
+    }
+    return n + s;
+}
+
+template <typename T>
+double BasicMatrixChain<T>::getNaiveCost() const
+{
+    double total = 0.0;
+    const double rows = static_cast<double>(operands[0]->getRows());
+    for (size_t i = 1; i < operands.size(); ++i)
+    {
+        total += rows * operands[i]->getRows() * operands[i]->getCols();
+    }
+    return total;
+}
+
+template <typename T>
+void BasicMatrixChain<T>::evaluateInto(const vector<BasicMatrixMultiplier<T, T> *> &multipliers, BasicMatrix<T> &out)
+{
+    if (multipliers.empty())
+    {
+        throw std::invalid_argument("At least one multiplier is needed");
+    }
+    for (const auto *multiplier : multipliers)
+    {
+        if (!multiplier)
+        {
+            throw std::invalid_argument("Multiplier must not be null");
+        }
+    }
+    const size_t n = operands.size();
+    if (steps.empty())
+    {
+        out = *operands[0];
+        return;
+    }
+    const size_t root = steps.size() - 1;
+
+    mutex lock;
+    condition_variable changed;
+    deque<size_t> ready;                              // steps whose operands are all computed
+    vector<int> waiting(steps.size(), 0);             // operands of every step that are still being computed
+    vector<BasicMatrix<T> *> results(steps.size());   // buffer of every computed or running step
+    vector<BasicMatrix<T> *> idle;                    // buffers free for the next step
+    size_t remaining = steps.size();
+    exception_ptr failure;
+
+    for (auto &buffer : buffers)
+    {
+        idle.push_back(buffer.get());
+    }
+    for (size_t s = 0; s < steps.size(); ++s)
+    {
+        waiting[s] = (steps[s].left >= n ? 1 : 0) + (steps[s].right >= n ? 1 : 0);
+        if (waiting[s] == 0)
+        {
+            ready.push_back(s);
+        }
+    }
+
+    // takes the smallest idle buffer that fits, else the largest one, else a new one; called under the lock
+    auto acquire = [&](size_t elements) -> BasicMatrix<T> *
+    {
+        auto better = [elements](const BasicMatrix<T> *x, const BasicMatrix<T> *y)
+        {
+            const bool xFits = x->getCapacity() >= elements;
+            const bool yFits = y->getCapacity() >= elements;
+            if (xFits != yFits)
+            {
+                return xFits;
+            }
+            return xFits ? x->getCapacity() < y->getCapacity() : x->getCapacity() > y->getCapacity();
+        };
+        size_t chosen = idle.size();
+        for (size_t i = 0; i < idle.size(); ++i)
+        {
+            if (chosen == idle.size() || better(idle[i], idle[chosen]))
+            {
+                chosen = i;
+            }
+        }
+        if (chosen == idle.size())
+        {
+            buffers.push_back(make_unique<BasicMatrix<T>>(0, 0));
+            return buffers.back().get();
+        }
+        BasicMatrix<T> *buffer = idle[chosen];
+        idle.erase(idle.begin() + chosen);
+        return buffer;
+    };
+
+    auto operand = [&](size_t id) -> const BasicMatrix<T> &
+    {
+        return id < n ? *operands[id] : *results[id - n];
+    };
+
+    auto lane = [&](BasicMatrixMultiplier<T, T> &multiplier)
+    {
+        unique_lock<mutex> guard(lock);
+        while (true)
+        {
+            changed.wait(guard, [&]
+                         { return !ready.empty() || remaining == 0 || failure; });
+            if (remaining == 0 || failure)
+            {
+                return;
+            }
+            const size_t s = ready.front();
+            ready.pop_front();
+            const Step &step = steps[s];
+            results[s] = s == root ? &out : acquire(step.rows * step.cols);
+            guard.unlock();
+
+            try
+            {
+                multiplier.multiplyInto(operand(step.left), operand(step.right), *results[s]);
+            }
+            catch (...)
+            {
+                guard.lock();
+                if (!failure)
+                {
+                    failure = current_exception();
+                }
+                changed.notify_all();
+                return;
+            }
+
+            guard.lock();
+            // the operands of this step are consumed, their buffers can take new results
+            for (size_t child : {step.left, step.right})
+            {
+                if (child >= n)
+                {
+                    idle.push_back(results[child - n]);
+                }
+            }
+            --remaining;
+            if (s != root && --waiting[step.parent] == 0)
+            {
+                ready.push_back(step.parent);
+            }
+            changed.notify_all();
+        }
+    };
+
+    // the calling thread is the first lane; more lanes than steps would only wait
+    const size_t lanes = min(multipliers.size(), steps.size());
+    vector<thread> threads;
+    for (size_t i = 1; i < lanes; ++i)
+    {
+        threads.emplace_back(lane, ref(*multipliers[i]));
+    }
+    lane(*multipliers[0]);
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    if (failure)
+    {
+        rethrow_exception(failure);
+    }
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrixChain<T>::evaluate(const vector<BasicMatrixMultiplier<T, T> *> &multipliers)
+{
+    BasicMatrix<T> result(0, 0);
+    evaluateInto(multipliers, result);
+    return result;
+}
+
+/**
+ * @brief Chain of double matrices
+ */
+using MatrixChain = BasicMatrixChain<double>;
+
+template class BasicMatrixChain<float>;
+template class BasicMatrixChain<double>;
+template class BasicMatrixChain<int32_t>;
+template class BasicMatrixChain<int64_t>;
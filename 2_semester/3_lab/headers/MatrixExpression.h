@@ -0,0 +1,474 @@
+#pragma once
+#include "MatrixMultiplier.h"
+#include "SimdMultiplier.h"
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * @brief Base of the matrix expression nodes (CRTP)
+ *
+ * The arithmetic operators on matrices do not compute anything: they build
+ * a small tree of nodes that only reference their operands. The tree is
+ * evaluated when it is assigned to a matrix, in a single pass over the
+ * destination that computes every element of the element-wise part
+ * (sums, differences, scaling) directly from the operands. Products
+ * cannot be evaluated element by element, so they are accumulated into the
+ * destination afterwards, scaled by their coefficient: C = alpha*A*B + beta*C
+ * is one scaling pass over C followed by C += alpha*A*B, with no
+ * temporary matrix.
+ *
+ * Every node provides:
+ *  - getRows(), getCols() - shape of the result,
+ *  - element(i, j) - value of the element-wise part (products count as zero),
+ *  - forEachProduct(coeff, f) - calls f(coefficient, product) for every product,
+ *  - usesInProduct(m) - whether matrix m is an operand of a product.
+ *
+ * @tparam E Derived node type
+ */
+template <typename E>
+class MatrixExpr
+{
+public:
+    /**
+     * @brief Gets the node as its derived type
+     * @return const E&
+     */
+    const E &derived() const { return static_cast<const E &>(*this); }
+
+    /**
+     * @brief Gets the number of rows of the result
+     * @return size_t - number of rows
+     */
+    size_t getRows() const { return derived().getRows(); }
+
+    /**
+     * @brief Gets the number of columns of the result
+     * @return size_t - number of columns
+     */
+    size_t getCols() const { return derived().getCols(); }
+};
+
+/**
+ * @brief Leaf node referencing a matrix
+ */
+template <typename T>
+class MatrixTerm : public MatrixExpr<MatrixTerm<T>>
+{
+private:
+    const BasicMatrix<T> &m; // referenced operand
+
+public:
+    using value_type = T;
+
+    explicit MatrixTerm(const BasicMatrix<T> &m) : m(m) {}
+
+    size_t getRows() const { return m.getRows(); }
+    size_t getCols() const { return m.getCols(); }
+    T element(size_t i, size_t j) const { return m.at(i, j); }
+
+    template <typename F>
+    void forEachProduct(T, F &&) const {}
+
+    bool usesInProduct(const void *) const { return false; }
+
+    /**
+     * @brief Gets the referenced matrix
+     * @return const BasicMatrix<T>&
+     */
+    const BasicMatrix<T> &matrix() const { return m; }
+};
+
+/**
+ * @brief Product node A * B, computed by a multiplier or by the built-in kernel
+ *
+ * Without a multiplier the product is accumulated straight into the
+ * destination (SimdMultiplier::multiplyAdd for doubles). With a
+ * multiplier, it is added by MatrixMultiplier::multiplyInto() in
+ * Accumulate::Add mode with the coefficient as alpha, so scaled products
+ * need no temporary either.
+ */
+template <typename T>
+class ProductTerm : public MatrixExpr<ProductTerm<T>>
+{
+private:
+    const BasicMatrix<T> &a;                  // left operand
+    const BasicMatrix<T> &b;                  // right operand
+    BasicMatrixMultiplier<T, T> *multiplier; // strategy computing the product, null for the built-in kernel
+
+public:
+    using value_type = T;
+
+    /**
+     * @brief Construct a new Product Term object
+     * @param a Left operand
+     * @param b Right operand
+     * @param multiplier Strategy to compute the product with, null for the built-in kernel
+     * @throw std::invalid_argument if a matrix is empty or the dimensions do not match
+     */
+    ProductTerm(const BasicMatrix<T> &a, const BasicMatrix<T> &b, BasicMatrixMultiplier<T, T> *multiplier = nullptr);
+
+    size_t getRows() const { return a.getRows(); }
+    size_t getCols() const { return b.getCols(); }
+    T element(size_t, size_t) const { return T(0); }
+
+    template <typename F>
+    void forEachProduct(T coeff, F &&f) const { f(coeff, *this); }
+
+    bool usesInProduct(const void *m) const { return m == &a || m == &b; }
+
+    /**
+     * @brief dst += coeff * A * B
+     * @param dst Destination of the same shape as the product, not an operand
+     * @param coeff Scale of the product
+     */
+    void accumulateInto(BasicMatrix<T> &dst, T coeff) const;
+};
+
+/**
+ * @brief Node multiplying an expression by a scalar
+ */
+template <typename E>
+class ScaledExpr : public MatrixExpr<ScaledExpr<E>>
+{
+public:
+    using value_type = typename E::value_type;
+
+private:
+    E expr;           // scaled expression
+    value_type scale; // scalar factor
+
+public:
+    ScaledExpr(value_type scale, const E &expr) : expr(expr), scale(scale) {}
+
+    size_t getRows() const { return expr.getRows(); }
+    size_t getCols() const { return expr.getCols(); }
+    value_type element(size_t i, size_t j) const { return scale * expr.element(i, j); }
+
+    template <typename F>
+    void forEachProduct(value_type coeff, F &&f) const { expr.forEachProduct(coeff * scale, f); }
+
+    bool usesInProduct(const void *m) const { return expr.usesInProduct(m); }
+
+    const E &getExpr() const { return expr; }
+    value_type getScale() const { return scale; }
+};
+
+/**
+ * @brief Node adding (or subtracting) two expressions of the same shape
+ */
+template <typename L, typename R, bool Subtract>
+class SumExpr : public MatrixExpr<SumExpr<L, R, Subtract>>
+{
+public:
+    using value_type = typename L::value_type;
+    static_assert(is_same_v<value_type, typename R::value_type>, "Operands must have the same element type");
+
+private:
+    L left;  // left operand
+    R right; // right operand
+
+public:
+    /**
+     * @brief Construct a new Sum Expr object
+     * @throw std::invalid_argument if the operands have different shapes
+     */
+    SumExpr(const L &left, const R &right) : left(left), right(right)
+    {
+        if (left.getRows() != right.getRows() || left.getCols() != right.getCols())
+        {
+            throw std::invalid_argument("Matrix dimensions do not match");
+        }
+    }
+
+    size_t getRows() const { return left.getRows(); }
+    size_t getCols() const { return left.getCols(); }
+
+    value_type element(size_t i, size_t j) const
+    {
+        return Subtract ? left.element(i, j) - right.element(i, j) : left.element(i, j) + right.element(i, j);
+    }
+
+    template <typename F>
+    void forEachProduct(value_type coeff, F &&f) const
+    {
+        left.forEachProduct(coeff, f);
+        right.forEachProduct(Subtract ? -coeff : coeff, f);
+    }
+
+    bool usesInProduct(const void *m) const { return left.usesInProduct(m) || right.usesInProduct(m); }
+};
+
+/**
+ * @brief Maps an operator operand (a matrix or an expression) to its node type
+ */
+template <typename X>
+struct MatrixOperand
+{
+    static constexpr bool value = is_base_of_v<MatrixExpr<X>, X>;
+    using node = X;
+    static const X &wrap(const X &x) { return x; }
+};
+
+template <typename T>
+struct MatrixOperand<BasicMatrix<T>>
+{
+    static constexpr bool value = true;
+    using node = MatrixTerm<T>;
+    static node wrap(const BasicMatrix<T> &m) { return node(m); }
+};
+
+template <typename L, typename R>
+using EnableMatrixOperands = enable_if_t<MatrixOperand<L>::value && MatrixOperand<R>::value>;
+
+/**
+ * @brief How an evaluated expression is combined with the destination
+ */
+enum class ExpressionMode
+{
+    Assign,  // dst = expr
+    Add,     // dst += expr
+    Subtract // dst -= expr
+};
+
+/**
+ * @brief Evaluates an expression into a matrix
+ *
+ * The element-wise part is computed in one pass over dst, then every
+ * product is accumulated into dst. If dst is itself an operand of a
+ * product, the expression is first evaluated into a temporary, since the
+ * product would otherwise read already overwritten elements.
+ *
+ * @param dst Destination, resized on assignment if the shape differs
+ * @param expression Expression to evaluate
+ * @param mode Assign, add or subtract
+ * @throw std::invalid_argument if mode is Add or Subtract and the shapes differ
+ */
+template <typename T, typename E>
+void evaluateExpression(BasicMatrix<T> &dst, const MatrixExpr<E> &expression, ExpressionMode mode)
+{
+    static_assert(is_same_v<T, typename E::value_type>, "Expression and matrix must have the same element type");
+    const E &expr = expression.derived();
+    const size_t rows = expr.getRows();
+    const size_t cols = expr.getCols();
+    const bool sameShape = dst.getRows() == rows && dst.getCols() == cols;
+
+    if (mode != ExpressionMode::Assign && !sameShape)
+    {
+        throw std::invalid_argument("Matrix dimensions do not match");
+    }
+
+    if (expr.usesInProduct(&dst))
+    {
+        BasicMatrix<T> value(rows, cols);
+        evaluateExpression(value, expression, ExpressionMode::Assign);
+        if (mode == ExpressionMode::Assign)
+        {
+            dst = std::move(value);
+        }
+        else
+        {
+            evaluateExpression(dst, mode == ExpressionMode::Add ? T(1) * value : T(-1) * value,
+                               ExpressionMode::Add);
+        }
+        return;
+    }
+
+    if (!sameShape)
+    {
+        dst = BasicMatrix<T>(rows, cols);
+    }
+
+    for (size_t i = 0; i < rows; ++i)
+    {
+        T *row = dst.rowPtr(i);
+        switch (mode)
+        {
+        case ExpressionMode::Assign:
+            for (size_t j = 0; j < cols; ++j)
+            {
+                row[j] = expr.element(i, j);
+            }
+            break;
+        case ExpressionMode::Add:
+            for (size_t j = 0; j < cols; ++j)
+            {
+                row[j] += expr.element(i, j);
+            }
+            break;
+        case ExpressionMode::Subtract:
+            for (size_t j = 0; j < cols; ++j)
+            {
+                row[j] -= expr.element(i, j);
+            }
+            break;
+        }
+    }
+
+    expr.forEachProduct(mode == ExpressionMode::Subtract ? T(-1) : T(1),
+                        [&dst](T coeff, const ProductTerm<T> &product)
+                        { product.accumulateInto(dst, coeff); });
+}
+
+template <typename T>
+ProductTerm<T>::ProductTerm(const BasicMatrix<T> &a, const BasicMatrix<T> &b, BasicMatrixMultiplier<T, T> *multiplier)
+    : a(a), b(b), multiplier(multiplier)
+{
+    if (a.getRows() == 0 || a.getCols() == 0 || b.getRows() == 0 || b.getCols() == 0)
+    {
+        throw std::invalid_argument("Cannot multiply empty matrices");
+    }
+    if (!BasicMatrix<T>::canMultiply(a, b))
+    {
+        throw std::invalid_argument("Matrix dimensions are not compatible for multiplication");
+    }
+}
+
+template <typename T>
+void ProductTerm<T>::accumulateInto(BasicMatrix<T> &dst, T coeff) const
+{
+    const size_t n = a.getRows();
+    const size_t m = b.getCols();
+
+    if (multiplier)
+    {
+        multiplier->multiplyInto(a, b, dst, Accumulate::Add, coeff);
+        return;
+    }
+
+    if constexpr (is_same_v<T, double>)
+    {
+        // multiplyAdd keeps no state, so one instance serves every thread
+        static const SimdMultiplier simd;
+        simd.multiplyAdd(n, m, a.getCols(), a.data(), a.getStride(), b.data(), b.getStride(),
+                         dst.data(), dst.getStride(), coeff);
+    }
+    else
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            T *row = dst.rowPtr(i);
+            for (size_t k = 0; k < a.getCols(); ++k)
+            {
+                const T aik = coeff * a.at(i, k);
+                const T *bRow = b.rowPtr(k);
+                for (size_t j = 0; j < m; ++j)
+                {
+                    row[j] += aik * bRow[j];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Builds the sum of two matrices or expressions
+ */
+template <typename L, typename R, typename = EnableMatrixOperands<L, R>>
+SumExpr<typename MatrixOperand<L>::node, typename MatrixOperand<R>::node, false> operator+(const L &left, const R &right)
+{
+    return {MatrixOperand<L>::wrap(left), MatrixOperand<R>::wrap(right)};
+}
+
+/**
+ * @brief Builds the difference of two matrices or expressions
+ */
+template <typename L, typename R, typename = EnableMatrixOperands<L, R>>
+SumExpr<typename MatrixOperand<L>::node, typename MatrixOperand<R>::node, true> operator-(const L &left, const R &right)
+{
+    return {MatrixOperand<L>::wrap(left), MatrixOperand<R>::wrap(right)};
+}
+
+/**
+ * @brief Builds a matrix or expression multiplied by a scalar
+ */
+template <typename X, typename = enable_if_t<MatrixOperand<X>::value>>
+ScaledExpr<typename MatrixOperand<X>::node> operator*(typename MatrixOperand<X>::node::value_type scale, const X &x)
+{
+    return {scale, MatrixOperand<X>::wrap(x)};
+}
+
+template <typename X, typename = enable_if_t<MatrixOperand<X>::value>>
+ScaledExpr<typename MatrixOperand<X>::node> operator*(const X &x, typename MatrixOperand<X>::node::value_type scale)
+{
+    return {scale, MatrixOperand<X>::wrap(x)};
+}
+
+/**
+ * @brief Builds the negation of a matrix or expression
+ */
+template <typename X, typename = enable_if_t<MatrixOperand<X>::value>>
+ScaledExpr<typename MatrixOperand<X>::node> operator-(const X &x)
+{
+    return {typename MatrixOperand<X>::node::value_type(-1), MatrixOperand<X>::wrap(x)};
+}
+
+/**
+ * @brief Builds the product of two matrices, computed by the built-in kernel
+ * @throw std::invalid_argument if a matrix is empty or the dimensions do not match
+ */
+template <typename T>
+ProductTerm<T> operator*(const BasicMatrix<T> &a, const BasicMatrix<T> &b)
+{
+    return ProductTerm<T>(a, b);
+}
+
+/**
+ * @brief Builds alpha * A * B from (alpha * A) * B, so the scalar ends up on the product
+ */
+template <typename T>
+ScaledExpr<ProductTerm<T>> operator*(const ScaledExpr<MatrixTerm<T>> &a, const BasicMatrix<T> &b)
+{
+    return {a.getScale(), ProductTerm<T>(a.getExpr().matrix(), b)};
+}
+
+template <typename T>
+ScaledExpr<ProductTerm<T>> operator*(const BasicMatrix<T> &a, const ScaledExpr<MatrixTerm<T>> &b)
+{
+    return {b.getScale(), ProductTerm<T>(a, b.getExpr().matrix())};
+}
+
+/**
+ * @brief Builds the product of two matrices, computed by a chosen multiplier
+ *
+ * @param a Left operand
+ * @param b Right operand
+ * @param multiplier Strategy to use, e.g. ParallelMultiplier; must outlive the expression
+ * @return ProductTerm<T> - product node for use in larger expressions
+ * @throw std::invalid_argument if a matrix is empty or the dimensions do not match
+ */
+template <typename T>
+ProductTerm<T> product(const BasicMatrix<T> &a, const BasicMatrix<T> &b, BasicMatrixMultiplier<T, T> &multiplier)
+{
+    return ProductTerm<T>(a, b, &multiplier);
+}
+
+template <typename T>
+template <typename E>
+BasicMatrix<T>::BasicMatrix(const MatrixExpr<E> &expr) : BasicMatrix(expr.getRows(), expr.getCols())
+{
+    evaluateExpression(*this, expr, ExpressionMode::Assign);
+}
+
+template <typename T>
+template <typename E>
+BasicMatrix<T> &BasicMatrix<T>::operator=(const MatrixExpr<E> &expr)
+{
+    evaluateExpression(*this, expr, ExpressionMode::Assign);
+    return *this;
+}
+
+template <typename T>
+template <typename E>
+BasicMatrix<T> &BasicMatrix<T>::operator+=(const MatrixExpr<E> &expr)
+{
+    evaluateExpression(*this, expr, ExpressionMode::Add);
+    return *this;
+}
+
+template <typename T>
+template <typename E>
+BasicMatrix<T> &BasicMatrix<T>::operator-=(const MatrixExpr<E> &expr)
+{
+    evaluateExpression(*this, expr, ExpressionMode::Subtract);
+    return *this;
+}
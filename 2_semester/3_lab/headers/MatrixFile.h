@@ -0,0 +1,282 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MATRIX_FILE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/**
+ * @brief Element type codes stored in a matrix file header
+ */
+enum class MatrixDType : uint32_t
+{
+    Float32 = 1,
+    Float64 = 2,
+    Int8 = 3,
+    Int16 = 4,
+    Int32 = 5,
+    Int64 = 6
+};
+
+/**
+ * @brief Maps a C++ element type to its MatrixDType code
+ */
+template <typename T>
+struct MatrixDTypeOf;
+
+template <>
+struct MatrixDTypeOf<float>
+{
+    static constexpr MatrixDType value = MatrixDType::Float32;
+};
+
+template <>
+struct MatrixDTypeOf<double>
+{
+    static constexpr MatrixDType value = MatrixDType::Float64;
+};
+
+template <>
+struct MatrixDTypeOf<int8_t>
+{
+    static constexpr MatrixDType value = MatrixDType::Int8;
+};
+
+template <>
+struct MatrixDTypeOf<int16_t>
+{
+    static constexpr MatrixDType value = MatrixDType::Int16;
+};
+
+template <>
+struct MatrixDTypeOf<int32_t>
+{
+    static constexpr MatrixDType value = MatrixDType::Int32;
+};
+
+template <>
+struct MatrixDTypeOf<int64_t>
+{
+    static constexpr MatrixDType value = MatrixDType::Int64;
+};
+
+/**
+ * @brief Fixed 64-byte header at the start of a binary matrix file
+ *
+ * The header is followed, at dataOffset, by rows * stride raw elements in
+ * row-major order. Rows are padded to stride elements so that, once the
+ * file is mapped, every row is as aligned as in an in-memory Matrix.
+ * All fields are in the byte order of the machine that wrote the file,
+ * endianTag tells readers whether that matches their own.
+ */
+struct MatrixFileHeader
+{
+    static constexpr char MAGIC[8] = {'M', 'A', 'T', 'R', 'I', 'X', 'B', 'N'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t ENDIAN_TAG = 0x01020304;
+    static constexpr uint32_t ROW_MAJOR = 0;
+
+    char magic[8];       // MAGIC
+    uint32_t version;    // format version, VERSION
+    uint32_t dtype;      // MatrixDType of the elements
+    uint32_t layout;     // ROW_MAJOR, the only layout so far
+    uint32_t alignment;  // alignment of the data and of every row, in bytes
+    uint64_t rows;       // number of rows
+    uint64_t cols;       // number of columns
+    uint64_t stride;     // distance between rows, in elements
+    uint64_t dataOffset; // offset of element (0,0) from the start of the file
+    uint32_t endianTag;  // ENDIAN_TAG as written by the producer
+    uint32_t reserved;   // zero
+
+    /**
+     * @brief Builds the header of a file holding T elements
+     * @param rows Number of rows
+     * @param cols Number of columns
+     * @param stride Distance between rows in elements, >= cols
+     * @param alignment Alignment of the data and of every row, in bytes
+     * @return MatrixFileHeader - header with the data starting right after it
+     */
+    template <typename T>
+    static MatrixFileHeader describe(uint64_t rows, uint64_t cols, uint64_t stride, uint32_t alignment);
+
+    /**
+     * @brief Checks that a header read from a file describes T elements that fit in the file
+     *
+     * The alignment field must be a power of two that both the data offset
+     * and the row length in bytes are multiples of, so a mapping aligned to
+     * it has every row aligned too.
+     *
+     * @param fileSize Size of the whole file in bytes
+     * @param path File name, used in error messages
+     * @param rowAlignment Alignment the caller needs for every row, in bytes (a power of two)
+     * @throw std::runtime_error if the file is not a matrix file of T elements, is truncated
+     * or its rows are not aligned to rowAlignment
+     */
+    template <typename T>
+    void validate(uint64_t fileSize, const string &path, uint64_t rowAlignment = alignof(T)) const;
+};
+
+static_assert(sizeof(MatrixFileHeader) == 64, "Matrix file header must stay 64 bytes");
+
+template <typename T>
+MatrixFileHeader MatrixFileHeader::describe(uint64_t rows, uint64_t cols, uint64_t stride, uint32_t alignment)
+{
+    MatrixFileHeader header{};
+    memcpy(header.magic, MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.dtype = static_cast<uint32_t>(MatrixDTypeOf<T>::value);
+    header.layout = ROW_MAJOR;
+    header.alignment = alignment;
+    header.rows = rows;
+    header.cols = cols;
+    header.stride = stride;
+    header.dataOffset = max<uint64_t>(sizeof(MatrixFileHeader), alignment);
+    header.endianTag = ENDIAN_TAG;
+    return header;
+}
+
+template <typename T>
+void MatrixFileHeader::validate(uint64_t fileSize, const string &path, uint64_t rowAlignment) const
+{
+    if (memcmp(magic, MAGIC, sizeof(magic)) != 0 || version != VERSION)
+    {
+        throw std::runtime_error("Not a matrix file: " + path);
+    }
+    if (endianTag != ENDIAN_TAG)
+    {
+        throw std::runtime_error("Matrix file has a different byte order: " + path);
+    }
+    if (dtype != static_cast<uint32_t>(MatrixDTypeOf<T>::value))
+    {
+        throw std::runtime_error("Matrix file has a different element type: " + path);
+    }
+    // the sizes come from the file, so the data size is only computed once it cannot overflow
+    if (layout != ROW_MAJOR || stride < cols || stride > UINT64_MAX / sizeof(T) || dataOffset > fileSize ||
+        (stride != 0 && rows > (UINT64_MAX - dataOffset) / sizeof(T) / stride) ||
+        fileSize < dataOffset + rows * stride * sizeof(T))
+    {
+        throw std::runtime_error("Matrix file is corrupted or truncated: " + path);
+    }
+    const uint64_t align = alignment;
+    if (align == 0 || (align & (align - 1)) != 0 || align < rowAlignment || align < alignof(T) ||
+        dataOffset % align != 0 || stride * sizeof(T) % align != 0)
+    {
+        throw std::runtime_error("Matrix file rows are not aligned: " + path);
+    }
+}
+
+/**
+ * @brief Private (copy-on-write) or shared mapping of a whole file
+ *
+ * On POSIX systems the file is mapped with mmap, so opening is O(1) and pages
+ * are loaded on first access. A private mapping is copy-on-write: the data
+ * can be modified in memory without touching the file. A shared mapping
+ * writes changes back to the file. Elsewhere the file is read into an
+ * aligned buffer instead (and written back on destruction if shared).
+ */
+class MappedFile
+{
+private:
+    string path;   // file name, used for the write-back fallback
+    void *address; // start of the mapping
+    size_t length; // size of the mapping in bytes
+    bool shared;   // changes go back to the file
+
+public:
+    /**
+     * @brief Maps a file into memory
+     * @param path File to map
+     * @param shared true to write changes back to the file
+     * @throw std::runtime_error if the file cannot be opened or mapped
+     */
+    MappedFile(const string &path, bool shared);
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /**
+     * @brief Unmaps the file
+     */
+    ~MappedFile();
+
+    /**
+     * @brief Gets the start of the mapping
+     * @return void* - page-aligned address of the first byte of the file
+     */
+    void *data() const { return address; }
+
+    /**
+     * @brief Gets the size of the mapping
+     * @return size_t - file size in bytes
+     */
+    size_t size() const { return length; }
+};
+
+MappedFile::MappedFile(const string &path, bool shared)
+    : path(path), address(nullptr), length(0), shared(shared)
+{
+#ifdef MATRIX_FILE_MMAP
+    int fd = ::open(path.c_str(), shared ? O_RDWR : O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Cannot open matrix file " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Cannot read the size of matrix file " + path);
+    }
+    length = static_cast<size_t>(info.st_size);
+
+    // a private mapping is still writable: modified pages are copied, the file stays intact
+    address = mmap(nullptr, length, PROT_READ | PROT_WRITE, shared ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED)
+    {
+        address = nullptr;
+        throw std::runtime_error("Cannot map matrix file " + path);
+    }
+#else
+    ifstream in(path, ios::binary | ios::ate);
+    if (!in)
+    {
+        throw std::runtime_error("Cannot open matrix file " + path);
+    }
+    length = static_cast<size_t>(in.tellg());
+    address = ::operator new(length, align_val_t(64));
+    in.seekg(0);
+    if (!in.read(static_cast<char *>(address), length))
+    {
+        ::operator delete(address, align_val_t(64));
+        throw std::runtime_error("Cannot read matrix file " + path);
+    }
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef MATRIX_FILE_MMAP
+    munmap(address, length);
+#else
+    if (shared)
+    {
+        ofstream out(path, ios::binary | ios::in | ios::out);
+        out.write(static_cast<const char *>(address), length);
+    }
+    ::operator delete(address, align_val_t(64));
+#endif
+}
@@ -4,6 +4,144 @@
 #pragma once
 #include "Matrix.h"
 #include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+
+/**
+ * @brief Type in which products of T are summed up by default
+ *
+ * Narrow integer inputs accumulate in int32_t so that sums of products do
+ * not overflow; every other type accumulates in itself.
+ */
+template <typename T>
+struct DefaultAccumulator
+{
+    using type = T;
+};
+
+template <>
+struct DefaultAccumulator<int8_t>
+{
+    using type = int32_t;
+};
+
+template <>
+struct DefaultAccumulator<int16_t>
+{
+    using type = int32_t;
+};
+
+/**
+ * @brief What multiplyInto() does with the previous contents of the output
+ */
+enum class Accumulate
+{
+    Overwrite, // out = A * B, out is resized to the product if needed
+    Add        // out += A * B, out must already have the shape of the product
+};
+
+/**
+ * @brief Thrown by a multiplication that was cancelled through its CancellationToken
+ */
+class MultiplyCancelled : public std::runtime_error
+{
+public:
+    MultiplyCancelled() : std::runtime_error("Multiplication was cancelled") {}
+};
+
+/**
+ * @brief Token through which the caller cancels an asynchronous multiplication and watches its progress
+ *
+ * Copies share one state, so the caller keeps a copy and hands another to
+ * multiplyAsync(). The multiplier splits the product into tiles (row
+ * blocks, cache blocks, recursion leaves - whatever the strategy works
+ * on), announces their number with start() and reports every finished one
+ * with finishTile(). Workers check for cancellation between tiles, so a
+ * cancelled product stops after at most one tile per worker.
+ */
+class CancellationToken
+{
+private:
+    struct State
+    {
+        atomic<bool> cancelled{false};
+        atomic<size_t> done{0};  // tiles finished
+        atomic<size_t> total{0}; // tiles announced, 0 before the work started
+    };
+    shared_ptr<State> state;
+
+public:
+    CancellationToken() : state(make_shared<State>()) {}
+
+    /**
+     * @brief Requests the multiplication to stop; it ends with MultiplyCancelled
+     */
+    void cancel() { state->cancelled = true; }
+
+    /**
+     * @brief Checks whether cancel() was called
+     */
+    bool isCancelled() const { return state->cancelled; }
+
+    /**
+     * @brief Gets the fraction of tiles done
+     * @return double - 0 before the work started, 1 once the product is complete
+     */
+    double progress() const
+    {
+        const size_t total = state->total;
+        return total == 0 ? 0.0 : min(1.0, static_cast<double>(state->done) / total);
+    }
+
+    /**
+     * @brief Announces the number of tiles of the product, called by the multiplier
+     * @throw MultiplyCancelled if the token is cancelled
+     */
+    void start(size_t tiles)
+    {
+        check();
+        state->done = 0;
+        state->total = max<size_t>(tiles, 1);
+    }
+
+    /**
+     * @brief Counts one finished tile, called by the multiplier's workers
+     * @throw MultiplyCancelled if the token is cancelled
+     */
+    void finishTile()
+    {
+        ++state->done;
+        check();
+    }
+
+    /**
+     * @brief Marks every tile as done, called once the product is complete
+     */
+    void finish()
+    {
+        if (state->total == 0)
+        {
+            state->total = 1;
+        }
+        state->done = state->total.load();
+    }
+
+    /**
+     * @brief Throws if the token is cancelled
+     * @throw MultiplyCancelled if cancel() was called
+     */
+    void check() const
+    {
+        if (state->cancelled)
+        {
+            throw MultiplyCancelled();
+        }
+    }
+};
 
 /**
  * @brief Abstract base class for matrix multiplication algorithms
@@ -11,35 +149,241 @@
  * This interface defines the contract for different matrix multiplication
  * implementations. It provides a common interface for both sequential
  * and parallel multiplication strategies.
+ *
+ * Every strategy implements compute(), which multiplyInto() calls to
+ * write into a matrix owned by the caller. Reusing one output across calls
+ * (see BasicMatrix::resize()) keeps steady-state loops free of allocations;
+ * multiply() is the convenience form returning a new matrix.
+ *
+ * multiplyAsync() runs a product on its own thread and returns a future.
+ * While it runs, the strategy reports its tiles to the CancellationToken
+ * (see startTiles() and finishTile()); in synchronous calls there is no
+ * token and the reports cost one null check.
+ *
+ * A multiplier is not reentrant: strategies keep buffers and the token of
+ * the running product between calls. Every public entry point locks the
+ * multiplier, so products started on one instance from several threads,
+ * synchronous or not, run one after another; use one multiplier per
+ * thread to overlap them.
+ *
+ * @tparam T Element type of the input matrices
+ * @tparam R Accumulation type, also the element type of the result
  */
-class MatrixMultiplier
+template <typename T, typename R = typename DefaultAccumulator<T>::type>
+class BasicMatrixMultiplier
 {
+private:
+    CancellationToken *token = nullptr; // token of the running asynchronous product, null otherwise; guarded by callMutex
+
 protected:
+    mutex callMutex; // held by every public entry point for the whole product
+
+    /**
+     * @brief Multiplies two matrices into a caller-owned output, called with callMutex held
+     * @param a First matrix
+     * @param b Second matrix
+     * @param out Receives the product; its storage is reused when large enough
+     * @param mode Overwrite out with alpha * A * B or add alpha * A * B to it
+     * @param alpha Scale applied to the product where it is stored
+     * @throw std::invalid_argument if the operands cannot be multiplied, out shares
+     * storage with one of them, or out has the wrong shape for Accumulate::Add
+     */
+    virtual void compute(const BasicMatrix<T> &a, const BasicMatrix<T> &b, BasicMatrix<R> &out,
+                         Accumulate mode, R alpha) = 0;
+
+    /**
+     * @brief Announces the number of tiles the product is split into
+     * @throw MultiplyCancelled if the running product was cancelled
+     */
+    void startTiles(size_t count) const
+    {
+        if (token)
+        {
+            token->start(count);
+        }
+    }
+
+    /**
+     * @brief Reports one finished tile, safe to call from several workers at once
+     * @throw MultiplyCancelled if the running product was cancelled
+     */
+    void finishTile() const
+    {
+        if (token)
+        {
+            token->finishTile();
+        }
+    }
+
+    /**
+     * @brief Throws if the running product was cancelled, for work that is not a tile (e.g. tuning)
+     */
+    void checkCancelled() const
+    {
+        if (token)
+        {
+            token->check();
+        }
+    }
+
+    /**
+     * @brief Runs compute() of another multiplier, which reports its tiles to this one's token
+     *
+     * Called from compute(), so this multiplier is locked already; the inner
+     * one is locked here, before its token is set.
+     *
+     * @param inner Multiplier doing the work
+     */
+    void delegateInto(BasicMatrixMultiplier &inner, const BasicMatrix<T> &a, const BasicMatrix<T> &b,
+                      BasicMatrix<R> &out, Accumulate mode, R alpha)
+    {
+        lock_guard<mutex> guard(inner.callMutex);
+        inner.token = token;
+        try
+        {
+            inner.compute(a, b, out, mode, alpha);
+        }
+        catch (...)
+        {
+            inner.token = nullptr;
+            throw;
+        }
+        inner.token = nullptr;
+    }
+
     /**
      * @brief Validates matrices for multiplication
      * @param a First matrix
      * @param b Second matrix
      */
-    void validateMatrices(const Matrix &a, const Matrix &b) const
+    void validateMatrices(const BasicMatrix<T> &a, const BasicMatrix<T> &b) const
     {
         if (a.getRows() == 0 || a.getCols() == 0 || b.getRows() == 0 || b.getCols() == 0)
         {
             throw std::invalid_argument("Cannot multiply empty matrices");
         }
-        if (!Matrix::canMultiply(a, b))
+        if (!BasicMatrix<T>::canMultiply(a, b))
         {
             throw std::invalid_argument("Matrix dimensions are not compatible for multiplication");
         }
     }
 
+    /**
+     * @brief Validates the operands and the output of multiplyInto()
+     * @param a First matrix
+     * @param b Second matrix
+     * @param out Output matrix
+     * @param mode Whether out is overwritten or accumulated into
+     * @throw std::invalid_argument if the operands cannot be multiplied, out shares
+     * storage with one of them, or out has the wrong shape for Accumulate::Add
+     */
+    void validateOutput(const BasicMatrix<T> &a, const BasicMatrix<T> &b, const BasicMatrix<R> &out,
+                        Accumulate mode) const
+    {
+        validateMatrices(a, b);
+        const void *target = out.data();
+        if (target && (target == static_cast<const void *>(a.data()) || target == static_cast<const void *>(b.data())))
+        {
+            throw std::invalid_argument("Output matrix must not share storage with an operand");
+        }
+        if (mode == Accumulate::Add && (out.getRows() != a.getRows() || out.getCols() != b.getCols()))
+        {
+            throw std::invalid_argument("Output matrix has the wrong shape for accumulation");
+        }
+    }
+
+    /**
+     * @brief Validates like validateOutput() and readies out for accumulating the product
+     *
+     * For Accumulate::Overwrite out is resized to the product and zeroed, so
+     * a strategy can always add A * B to it.
+     */
+    void prepareOutput(const BasicMatrix<T> &a, const BasicMatrix<T> &b, BasicMatrix<R> &out, Accumulate mode) const
+    {
+        validateOutput(a, b, out, mode);
+        if (mode == Accumulate::Add)
+        {
+            return;
+        }
+        if (out.getRows() != a.getRows() || out.getCols() != b.getCols())
+        {
+            out.resize(a.getRows(), b.getCols()); // zero-filled in the new shape
+            return;
+        }
+        for (size_t i = 0; i < out.getRows(); ++i)
+        {
+            memset(out.rowPtr(i), 0, out.getCols() * sizeof(R));
+        }
+    }
+
 public:
     /**
      * @brief Multiplies two matrices
      * @param a First matrix
      * @param b Second matrix
-     * @return Matrix - result of matrix multiplication
+     * @return BasicMatrix<R> - result of matrix multiplication
+     */
+    virtual BasicMatrix<R> multiply(const BasicMatrix<T> &a, const BasicMatrix<T> &b)
+    {
+        BasicMatrix<R> result(0, 0);
+        multiplyInto(a, b, result, Accumulate::Overwrite);
+        return result;
+    }
+
+    /**
+     * @brief Multiplies two matrices into a caller-owned output
+     * @param a First matrix
+     * @param b Second matrix
+     * @param out Receives the product; its storage is reused when large enough
+     * @param mode Overwrite out with alpha * A * B or add alpha * A * B to it
+     * @param alpha Scale applied to the product where it is stored, so scaled sums need no temporary
+     * @throw std::invalid_argument if the operands cannot be multiplied, out shares
+     * storage with one of them, or out has the wrong shape for Accumulate::Add
+     */
+    void multiplyInto(const BasicMatrix<T> &a, const BasicMatrix<T> &b, BasicMatrix<R> &out,
+                      Accumulate mode = Accumulate::Overwrite, R alpha = R(1))
+    {
+        lock_guard<mutex> guard(callMutex);
+        compute(a, b, out, mode, alpha);
+    }
+
+    /**
+     * @brief Multiplies two matrices on a separate thread
+     *
+     * The operands are not copied: they, and the multiplier, must live until
+     * the future is ready. The product holds the multiplier's lock like a
+     * synchronous call, so it waits for (and delays) every other product of
+     * this multiplier. Destroying the future waits for the product, so
+     * cancel the token first to abandon it.
+     *
+     * @param a First matrix
+     * @param b Second matrix
+     * @param cancel Token to cancel the product and read its progress through
+     * @return future<BasicMatrix<R>> - the product; get() rethrows MultiplyCancelled
+     * or the error of the multiplication
      */
-    virtual Matrix multiply(const Matrix &a, const Matrix &b) = 0;
+    future<BasicMatrix<R>> multiplyAsync(const BasicMatrix<T> &a, const BasicMatrix<T> &b,
+                                         CancellationToken cancel = CancellationToken())
+    {
+        return async(launch::async, [this, &a, &b, cancel]() mutable
+                     {
+            lock_guard<mutex> guard(callMutex);
+            cancel.check();
+            BasicMatrix<R> result(0, 0);
+            token = &cancel;
+            try
+            {
+                compute(a, b, result, Accumulate::Overwrite, R(1));
+            }
+            catch (...)
+            {
+                token = nullptr;
+                throw;
+            }
+            token = nullptr;
+            cancel.finish();
+            return result; });
+    }
 
     /**
      * @brief Gets the name of the multiplication algorithm
@@ -50,5 +394,17 @@ public:
     /**
      * @brief Virtual destructor
      */
-    virtual ~MatrixMultiplier() = default;
-};
\ No newline at end of file
+    virtual ~BasicMatrixMultiplier() = default;
+};
+
+/**
+ * @brief Multiplier of double matrices, the base of the double-only strategies
+ */
+using MatrixMultiplier = BasicMatrixMultiplier<double>;
+
+template class BasicMatrixMultiplier<float>;
+template class BasicMatrixMultiplier<double>;
+template class BasicMatrixMultiplier<int32_t>;
+template class BasicMatrixMultiplier<int64_t>;
+template class BasicMatrixMultiplier<int8_t, int32_t>;
+template class BasicMatrixMultiplier<int16_t, int32_t>;
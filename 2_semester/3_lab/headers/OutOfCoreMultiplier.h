@@ -0,0 +1,480 @@
+#pragma once
+#include "MatrixMultiplier.h"
+#include "SimdMultiplier.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Block-wise reader and writer of a binary matrix file of doubles
+ *
+ * Only the requested block is transferred, so files much larger than memory
+ * can be processed piece by piece. One object must not be used by two
+ * threads at the same time.
+ */
+class MatrixFileStream
+{
+private:
+    string path;             // file name, used in error messages
+    fstream file;            // open file
+    MatrixFileHeader header; // header read from (or written to) the file
+
+public:
+    /**
+     * @brief Opens an existing matrix file
+     * @param path File written by Matrix::save() or create()
+     * @param writable true to allow write()
+     * @throw std::runtime_error if the file cannot be opened or is not a matrix file of doubles
+     */
+    MatrixFileStream(const string &path, bool writable = false);
+
+    /**
+     * @brief Creates a zero-filled matrix file without writing its elements one by one
+     * @param path File to create, overwritten if it exists
+     * @param rows Number of rows
+     * @param cols Number of columns
+     * @throw std::runtime_error if the file cannot be created
+     */
+    static void create(const string &path, size_t rows, size_t cols);
+
+    /**
+     * @brief Gets the number of rows in the file
+     * @return size_t - number of rows
+     */
+    size_t getRows() const { return header.rows; }
+
+    /**
+     * @brief Gets the number of columns in the file
+     * @return size_t - number of columns
+     */
+    size_t getCols() const { return header.cols; }
+
+    /**
+     * @brief Reads the block [row, row+rows) x [col, col+cols)
+     * @param dst Destination of element (row, col), rows ld elements apart
+     * @throw std::runtime_error on a read error
+     */
+    void read(size_t row, size_t col, size_t rows, size_t cols, double *dst, size_t ld);
+
+    /**
+     * @brief Writes the block [row, row+rows) x [col, col+cols)
+     * @param src Source of element (row, col), rows ld elements apart
+     * @throw std::runtime_error on a write error
+     */
+    void write(size_t row, size_t col, size_t rows, size_t cols, const double *src, size_t ld);
+};
+
+MatrixFileStream::MatrixFileStream(const string &path, bool writable)
+    : path(path), file(path, writable ? ios::binary | ios::in | ios::out : ios::binary | ios::in)
+{
+    if (!file || !file.read(reinterpret_cast<char *>(&header), sizeof(header)))
+    {
+        throw std::runtime_error("Cannot open matrix file " + path);
+    }
+    header.validate<double>(filesystem::file_size(path), path);
+}
+
+void MatrixFileStream::create(const string &path, size_t rows, size_t cols)
+{
+    const MatrixFileHeader header =
+        MatrixFileHeader::describe<double>(rows, cols, Matrix::paddedStride(cols), Matrix::ALIGNMENT);
+    {
+        ofstream out(path, ios::binary | ios::trunc);
+        if (!out || !out.write(reinterpret_cast<const char *>(&header), sizeof(header)))
+        {
+            throw std::runtime_error("Cannot create matrix file " + path);
+        }
+    }
+    // extending the file fills it with zeros (a sparse file on most systems)
+    filesystem::resize_file(path, header.dataOffset + header.rows * header.stride * sizeof(double));
+}
+
+void MatrixFileStream::read(size_t row, size_t col, size_t rows, size_t cols, double *dst, size_t ld)
+{
+    for (size_t i = 0; i < rows; ++i)
+    {
+        file.seekg(header.dataOffset + ((row + i) * header.stride + col) * sizeof(double));
+        if (!file.read(reinterpret_cast<char *>(dst + i * ld), cols * sizeof(double)))
+        {
+            throw std::runtime_error("Cannot read matrix file " + path);
+        }
+    }
+}
+
+void MatrixFileStream::write(size_t row, size_t col, size_t rows, size_t cols, const double *src, size_t ld)
+{
+    for (size_t i = 0; i < rows; ++i)
+    {
+        file.seekp(header.dataOffset + ((row + i) * header.stride + col) * sizeof(double));
+        if (!file.write(reinterpret_cast<const char *>(src + i * ld), cols * sizeof(double)))
+        {
+            throw std::runtime_error("Cannot write matrix file " + path);
+        }
+    }
+    file.flush();
+}
+
+/**
+ * @brief I/O and timing figures of the last out-of-core multiplication
+ */
+struct OutOfCoreStats
+{
+    size_t bytesRead = 0;    // bytes of A and B transferred into the block buffers
+    size_t bytesWritten = 0; // bytes of C written to the output file
+    double stallMs = 0.0;    // time compute waited for a block that was not loaded yet
+    double computeMs = 0.0;  // time spent multiplying blocks
+    size_t blockSize = 0;    // edge of the square blocks derived from the budget
+};
+
+/**
+ * @brief Multiplication of matrices stored in files that may exceed memory
+ *
+ * C is computed in square blockSize x blockSize blocks. For every block of C
+ * the matching blocks of A and B are streamed along the shared dimension,
+ * multiplied into an in-memory C block and the finished block is written to
+ * the output file. Reads are double-buffered: while one pair of A and B
+ * blocks is multiplied, an I/O thread already loads the next pair into the
+ * other buffers, so disk and compute overlap. The block size is the largest
+ * one for which the two buffer pairs and the C block fit in the memory budget.
+ *
+ * multiplyFiles() works on files only. multiply() accepts ordinary or mapped
+ * matrices (see Matrix::mapFile()), writes C into a file and returns it mapped,
+ * so the result is never fully resident either. multiplyInto() streams the
+ * finished blocks into a caller-owned matrix instead, which may itself be
+ * mapped with write-back.
+ */
+class OutOfCoreMultiplier : public MatrixMultiplier
+{
+private:
+    // copies block [row, row+rows) x [col, col+cols) of an operand to dst (ld elements per row)
+    using BlockReader = function<void(size_t row, size_t col, size_t rows, size_t cols, double *dst, size_t ld)>;
+    // stores block [row, row+rows) x [col, col+cols) of the result from src (ld elements per row)
+    using BlockWriter = function<void(size_t row, size_t col, size_t rows, size_t cols, const double *src, size_t ld)>;
+
+    size_t blockSize;     // edge of the square blocks
+    string outputPath;    // file receiving the result of multiply(), empty for a scratch file
+    SimdMultiplier base;  // kernel multiplying the in-memory blocks
+    ThreadPool io;        // single thread loading the next blocks
+    OutOfCoreStats stats; // figures of the last multiplication
+
+    /**
+     * @brief Streams C = A * B block by block through the readers and the writer
+     * @param n Rows of A and C
+     * @param m Columns of B and C
+     * @param inner Columns of A, rows of B
+     */
+    void stream(size_t n, size_t m, size_t inner,
+                const BlockReader &readA, const BlockReader &readB, const BlockWriter &writeC);
+
+    /**
+     * @brief Picks a fresh scratch file name in the temporary directory
+     */
+    static string scratchPath();
+
+    /**
+     * @brief Makes a reader copying blocks out of an in-memory or mapped matrix
+     */
+    static BlockReader readFrom(const Matrix &src);
+
+protected:
+    /**
+     * @brief Multiplies two matrices block by block into a caller-owned output
+     * @param a First matrix, usually mapped from a file
+     * @param b Second matrix, usually mapped from a file
+     * @param out Receives (or accumulates) the product
+     * @param mode Overwrite out or add the product to it
+     * @param alpha Scale applied to the product
+     */
+    void compute(const Matrix &a, const Matrix &b, Matrix &out, Accumulate mode, double alpha) override;
+
+public:
+    /**
+     * @brief Construct a new Out Of Core Multiplier object
+     * @param memoryBudget Bytes of memory the block buffers may use
+     * @param outputPath File that receives the result of multiply();
+     *                   empty to use a scratch file deleted once mapped
+     * @throw std::invalid_argument if the budget cannot hold 8 x 8 blocks
+     */
+    explicit OutOfCoreMultiplier(size_t memoryBudget = size_t(256) << 20, const string &outputPath = "");
+
+    /**
+     * @brief Multiplies two matrices, writing the result to the output file
+     * @param a First matrix, usually mapped from a file
+     * @param b Second matrix, usually mapped from a file
+     * @return Matrix - result, mapped from the output file
+     */
+    Matrix multiply(const Matrix &a, const Matrix &b) override;
+
+    /**
+     * @brief Multiplies two matrix files into a third without mapping them
+     * @param pathA File of the first matrix
+     * @param pathB File of the second matrix
+     * @param pathC File to create for the result, overwritten if it exists
+     * @throw std::invalid_argument if the matrices cannot be multiplied or pathC is one of the inputs
+     * @throw std::runtime_error if a file cannot be read or written
+     */
+    void multiplyFiles(const string &pathA, const string &pathB, const string &pathC);
+
+    /**
+     * @brief Gets the edge of the blocks derived from the memory budget
+     * @return size_t - rows and columns of one block
+     */
+    size_t getBlockSize() const { return blockSize; }
+
+    /**
+     * @brief Gets the I/O volume and stall time of the last multiplication
+     * @return const OutOfCoreStats&
+     */
+    const OutOfCoreStats &getStats() const { return stats; }
+
+    /**
+     * @brief Prints the statistics of the last multiplication
+     * @param os Stream to print to
+     */
+    void printStats(ostream &os) const;
+
+    /**
+     * @brief Gets the name of the multiplication algorithm
+     * @return const char* - "Out-of-core" as the algorithm identifier
+     */
+    const char *getName() const override { return "Out-of-core"; }
+};
+
+OutOfCoreMultiplier::OutOfCoreMultiplier(size_t memoryBudget, const string &outputPath)
+    : outputPath(outputPath), io(1)
+{
+    // two A and two B buffers for double buffering plus the C block
+    blockSize = static_cast<size_t>(sqrt(static_cast<double>(memoryBudget / (5 * sizeof(double)))));
+    blockSize -= blockSize % 8;
+    if (blockSize == 0)
+    {
+        throw std::invalid_argument("Memory budget is too small for out-of-core blocks");
+    }
+}
+
+string OutOfCoreMultiplier::scratchPath()
+{
+    static atomic<size_t> counter{0};
+    // the random part keeps concurrent processes apart, the counter the calls of one process
+    const string name = "out_of_core_" + to_string(random_device{}()) + "_" + to_string(counter++) + ".bin";
+    return (filesystem::temp_directory_path() / name).string();
+}
+
+void OutOfCoreMultiplier::stream(size_t n, size_t m, size_t inner,
+                                 const BlockReader &readA, const BlockReader &readB, const BlockWriter &writeC)
+{
+    stats = OutOfCoreStats();
+    stats.blockSize = blockSize;
+
+    struct Step
+    {
+        size_t i, j, k; // top-left corner: A(i,k), B(k,j), C(i,j)
+    };
+    vector<Step> steps;
+    for (size_t i = 0; i < n; i += blockSize)
+    {
+        for (size_t j = 0; j < m; j += blockSize)
+        {
+            for (size_t k = 0; k < inner; k += blockSize)
+            {
+                steps.push_back({i, j, k});
+            }
+        }
+    }
+
+    startTiles(steps.size()); // every step is one tile
+
+    // operands smaller than a block only need buffers of their own size
+    const size_t maxRows = min(blockSize, n);
+    const size_t maxDepth = min(blockSize, inner);
+    const size_t maxCols = min(blockSize, m);
+    vector<double> bufA[2], bufB[2];
+    for (int s = 0; s < 2; ++s)
+    {
+        bufA[s].resize(maxRows * maxDepth);
+        bufB[s].resize(maxDepth * maxCols);
+    }
+    vector<double> blockC(maxRows * maxCols);
+
+    // loads the operands of one step into buffer pair s, on the I/O thread
+    auto load = [&](size_t t, int s)
+    {
+        return io.submit([&, t, s]
+                         {
+            const Step &step = steps[t];
+            const size_t rows = min(blockSize, n - step.i);
+            const size_t depth = min(blockSize, inner - step.k);
+            const size_t cols = min(blockSize, m - step.j);
+            readA(step.i, step.k, rows, depth, bufA[s].data(), depth);
+            readB(step.k, step.j, depth, cols, bufB[s].data(), cols);
+            stats.bytesRead += (rows + cols) * depth * sizeof(double); });
+    };
+
+    future<void> pending;
+    if (!steps.empty())
+    {
+        pending = load(0, 0);
+    }
+
+    try
+    {
+        for (size_t t = 0; t < steps.size(); ++t)
+        {
+            const Step &step = steps[t];
+            const size_t rows = min(blockSize, n - step.i);
+            const size_t depth = min(blockSize, inner - step.k);
+            const size_t cols = min(blockSize, m - step.j);
+            const int s = t % 2;
+
+            auto waitStart = chrono::steady_clock::now();
+            pending.get();
+            auto computeStart = chrono::steady_clock::now();
+            stats.stallMs += chrono::duration<double, milli>(computeStart - waitStart).count();
+
+            // the other buffer pair is free again, start filling it with the next step
+            if (t + 1 < steps.size())
+            {
+                pending = load(t + 1, 1 - s);
+            }
+
+            if (step.k == 0)
+            {
+                fill(blockC.begin(), blockC.begin() + rows * cols, 0.0);
+            }
+            base.multiplyAdd(rows, cols, depth, bufA[s].data(), depth, bufB[s].data(), cols,
+                             blockC.data(), cols);
+            stats.computeMs += chrono::duration<double, milli>(chrono::steady_clock::now() - computeStart).count();
+
+            if (step.k + depth == inner)
+            {
+                writeC(step.i, step.j, rows, cols, blockC.data(), cols);
+                stats.bytesWritten += rows * cols * sizeof(double);
+            }
+            finishTile();
+        }
+    }
+    catch (...)
+    {
+        // the I/O thread may still be filling a buffer owned by this frame
+        if (pending.valid())
+        {
+            pending.wait();
+        }
+        throw;
+    }
+
+    // an empty shared dimension still produces a (zero) result
+    if (inner == 0 && n > 0 && m > 0)
+    {
+        fill(blockC.begin(), blockC.end(), 0.0);
+        for (size_t i = 0; i < n; i += blockSize)
+        {
+            for (size_t j = 0; j < m; j += blockSize)
+            {
+                writeC(i, j, min(blockSize, n - i), min(blockSize, m - j), blockC.data(), maxCols);
+            }
+        }
+    }
+}
+
+OutOfCoreMultiplier::BlockReader OutOfCoreMultiplier::readFrom(const Matrix &src)
+{
+    return [&src](size_t row, size_t col, size_t rows, size_t cols, double *dst, size_t ld)
+    {
+        for (size_t i = 0; i < rows; ++i)
+        {
+            copy_n(src.rowPtr(row + i) + col, cols, dst + i * ld);
+        }
+    };
+}
+
+Matrix OutOfCoreMultiplier::multiply(const Matrix &a, const Matrix &b)
+{
+    lock_guard<mutex> guard(callMutex);
+    validateMatrices(a, b);
+
+    const bool scratch = outputPath.empty();
+    const string path = scratch ? scratchPath() : outputPath;
+    MatrixFileStream::create(path, a.getRows(), b.getCols());
+    {
+        MatrixFileStream out(path, true);
+        stream(a.getRows(), b.getCols(), a.getCols(), readFrom(a), readFrom(b),
+               [&out](size_t row, size_t col, size_t rows, size_t cols, const double *src, size_t ld)
+               { out.write(row, col, rows, cols, src, ld); });
+    }
+
+    Matrix result = Matrix::mapFile(path);
+    if (scratch)
+    {
+        // the mapping keeps the data reachable, the name is no longer needed
+        filesystem::remove(path);
+    }
+    return result;
+}
+
+void OutOfCoreMultiplier::compute(const Matrix &a, const Matrix &b, Matrix &out, Accumulate mode,
+                                  double alpha)
+{
+    validateOutput(a, b, out, mode);
+    if (mode == Accumulate::Overwrite)
+    {
+        out.resize(a.getRows(), b.getCols()); // every block is written, no zeroing needed
+    }
+
+    const bool add = mode == Accumulate::Add;
+    stream(a.getRows(), b.getCols(), a.getCols(), readFrom(a), readFrom(b),
+           [&out, add, alpha](size_t row, size_t col, size_t rows, size_t cols, const double *src, size_t ld)
+           {
+               for (size_t i = 0; i < rows; ++i)
+               {
+                   double *dst = out.rowPtr(row + i) + col;
+                   const double *block = src + i * ld;
+                   for (size_t j = 0; j < cols; ++j)
+                   {
+                       dst[j] = add ? dst[j] + alpha * block[j] : alpha * block[j];
+                   }
+               }
+           });
+}
+
+void OutOfCoreMultiplier::multiplyFiles(const string &pathA, const string &pathB, const string &pathC)
+{
+    lock_guard<mutex> guard(callMutex);
+    MatrixFileStream a(pathA);
+    MatrixFileStream b(pathB);
+    if (a.getCols() != b.getRows())
+    {
+        throw std::invalid_argument("Matrix dimensions are not compatible for multiplication");
+    }
+    // create() truncates pathC, which would zero an input still being read; equivalent() also sees links
+    error_code ec;
+    if (filesystem::equivalent(pathC, pathA, ec) || filesystem::equivalent(pathC, pathB, ec))
+    {
+        throw std::invalid_argument("Output file must not be one of the input files: " + pathC);
+    }
+
+    MatrixFileStream::create(pathC, a.getRows(), b.getCols());
+    MatrixFileStream c(pathC, true);
+    stream(a.getRows(), b.getCols(), a.getCols(),
+           [&a](size_t row, size_t col, size_t rows, size_t cols, double *dst, size_t ld)
+           { a.read(row, col, rows, cols, dst, ld); },
+           [&b](size_t row, size_t col, size_t rows, size_t cols, double *dst, size_t ld)
+           { b.read(row, col, rows, cols, dst, ld); },
+           [&c](size_t row, size_t col, size_t rows, size_t cols, const double *src, size_t ld)
+           { c.write(row, col, rows, cols, src, ld); });
+}
+
+void OutOfCoreMultiplier::printStats(ostream &os) const
+{
+    os << "  blocks " << stats.blockSize << "x" << stats.blockSize << ", read " << fixed << setprecision(2)
+       << stats.bytesRead / 1048576.0 << " MiB, written " << stats.bytesWritten / 1048576.0
+       << " MiB, compute " << stats.computeMs << " ms, I/O stall " << stats.stallMs << " ms\n";
+}
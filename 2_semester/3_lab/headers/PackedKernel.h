@@ -0,0 +1,224 @@
+#pragma once
+#include "Matrix.h"
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include <stdexcept>
+
+/**
+ * @brief Multiplication stage that packs A and B into contiguous panels first
+ *
+ * For every innerBlock x colBlock block of B (sized for L2/L3), B is copied
+ * into NR-column panels stored k-major, and every rowBlock x innerBlock block
+ * of A (sized for L2) into MR-row panels stored k-major. The register-tile
+ * kernel then streams both panels with unit stride instead of walking down
+ * columns of B. Partial panels at the edges are zero-padded, so the kernel
+ * always works on full MR x NR tiles.
+ *
+ * The packing buffers only grow and are reused by later calls. An object
+ * must not be used by two threads at the same time; parallel callers keep
+ * one PackedKernel per worker.
+ *
+ * @tparam T Element type of A and B
+ * @tparam R Accumulation type: panels are converted to R while packing
+ */
+template <typename T, typename R>
+class BasicPackedKernel
+{
+public:
+    static constexpr size_t MR = 4; // rows of a register tile
+    static constexpr size_t NR = 8; // columns of a register tile
+
+private:
+    size_t rowBlock;        // rows of A per packed block
+    size_t innerBlock;      // shared dimension per packed block
+    size_t colBlock;        // columns of B per packed block
+    vector<R> packedA;      // rowBlock x innerBlock block of A in MR-row panels
+    vector<R> packedB;      // innerBlock x colBlock block of B in NR-column panels
+
+    /**
+     * @brief Copies A[rowBegin..rowBegin+rows, kBegin..kBegin+kc] into MR-row panels
+     */
+    void packA(const BasicMatrix<T> &a, size_t rowBegin, size_t rows, size_t kBegin, size_t kc);
+
+    /**
+     * @brief Copies B[kBegin..kBegin+kc, colBegin..colBegin+cols] into NR-column panels
+     */
+    void packB(const BasicMatrix<T> &b, size_t kBegin, size_t kc, size_t colBegin, size_t cols);
+
+    /**
+     * @brief C[0..rows, 0..cols] += alpha * packed A panel * packed B panel
+     */
+    static void kernel(size_t kc, const R *aPanel, const R *bPanel,
+                       R *c, size_t ldc, size_t rows, size_t cols, R alpha);
+
+public:
+    /**
+     * @brief Construct a new Packed Kernel object
+     * @param rowBlock Rows of A per packed block
+     * @param innerBlock Shared dimension per packed block
+     * @param colBlock Columns of B per packed block
+     * @throw std::invalid_argument if any block size is zero
+     */
+    explicit BasicPackedKernel(size_t rowBlock = 128, size_t innerBlock = 256, size_t colBlock = 2048);
+
+    /**
+     * @brief Accumulates rows [rowBegin, rowEnd) of C += alpha * A * B
+     * @param a First matrix
+     * @param b Second matrix
+     * @param c Result matrix, a.getRows() x b.getCols()
+     * @param rowBegin First row of C to compute
+     * @param rowEnd Row after the last one to compute
+     * @param onBlock Called after every packed block of C, e.g. to report progress; may throw to stop
+     * @param alpha Scale applied to the product before it is added
+     */
+    void multiplyRows(const BasicMatrix<T> &a, const BasicMatrix<T> &b, BasicMatrix<R> &c,
+                      size_t rowBegin, size_t rowEnd, const function<void()> &onBlock = nullptr,
+                      R alpha = R(1));
+
+    /**
+     * @brief Gets how many times multiplyRows() calls onBlock for the given sizes
+     * @param rows Rows of C being computed
+     * @param inner Columns of A, rows of B
+     * @param cols Columns of B
+     * @return size_t - number of packed blocks
+     */
+    size_t blockCount(size_t rows, size_t inner, size_t cols) const
+    {
+        return ((rows + rowBlock - 1) / rowBlock) * ((inner + innerBlock - 1) / innerBlock) *
+               ((cols + colBlock - 1) / colBlock);
+    }
+};
+
+/**
+ * @brief Packing stage for double matrices
+ */
+using PackedKernel = BasicPackedKernel<double, double>;
+
+template <typename T, typename R>
+BasicPackedKernel<T, R>::BasicPackedKernel(size_t rowBlock, size_t innerBlock, size_t colBlock)
+    : rowBlock((rowBlock + MR - 1) / MR * MR), innerBlock(innerBlock),
+      colBlock((colBlock + NR - 1) / NR * NR)
+{
+    if (rowBlock == 0 || innerBlock == 0 || colBlock == 0)
+    {
+        throw std::invalid_argument("Block sizes must be positive");
+    }
+}
+
+template <typename T, typename R>
+void BasicPackedKernel<T, R>::packA(const BasicMatrix<T> &a, size_t rowBegin, size_t rows, size_t kBegin, size_t kc)
+{
+    const size_t panels = (rows + MR - 1) / MR;
+    packedA.resize(max(packedA.size(), panels * MR * kc));
+
+    R *dst = packedA.data();
+    for (size_t p = 0; p < panels; ++p)
+    {
+        const size_t r0 = p * MR;
+        const size_t panelRows = min(MR, rows - r0);
+        for (size_t k = 0; k < kc; ++k)
+        {
+            for (size_t r = 0; r < MR; ++r)
+            {
+                *dst++ = r < panelRows ? static_cast<R>(a.at(rowBegin + r0 + r, kBegin + k)) : R(0);
+            }
+        }
+    }
+}
+
+template <typename T, typename R>
+void BasicPackedKernel<T, R>::packB(const BasicMatrix<T> &b, size_t kBegin, size_t kc, size_t colBegin, size_t cols)
+{
+    const size_t panels = (cols + NR - 1) / NR;
+    packedB.resize(max(packedB.size(), panels * NR * kc));
+
+    R *dst = packedB.data();
+    for (size_t p = 0; p < panels; ++p)
+    {
+        const size_t c0 = colBegin + p * NR;
+        const size_t panelCols = min(NR, cols - p * NR);
+        for (size_t k = 0; k < kc; ++k)
+        {
+            const T *bRow = b.rowPtr(kBegin + k) + c0;
+            size_t s = 0;
+            for (; s < panelCols; ++s)
+            {
+                *dst++ = static_cast<R>(bRow[s]);
+            }
+            for (; s < NR; ++s)
+            {
+                *dst++ = R(0);
+            }
+        }
+    }
+}
+
+template <typename T, typename R>
+void BasicPackedKernel<T, R>::kernel(size_t kc, const R *aPanel, const R *bPanel,
+                                     R *c, size_t ldc, size_t rows, size_t cols, R alpha)
+{
+    R acc[MR][NR] = {};
+    for (size_t k = 0; k < kc; ++k)
+    {
+        const R *aK = aPanel + k * MR;
+        const R *bK = bPanel + k * NR;
+        for (size_t r = 0; r < MR; ++r)
+        {
+            for (size_t s = 0; s < NR; ++s)
+            {
+                acc[r][s] += aK[r] * bK[s];
+            }
+        }
+    }
+
+    for (size_t r = 0; r < rows; ++r)
+    {
+        R *cRow = c + r * ldc;
+        for (size_t s = 0; s < cols; ++s)
+        {
+            cRow[s] += alpha * acc[r][s];
+        }
+    }
+}
+
+template <typename T, typename R>
+void BasicPackedKernel<T, R>::multiplyRows(const BasicMatrix<T> &a, const BasicMatrix<T> &b, BasicMatrix<R> &c,
+                                           size_t rowBegin, size_t rowEnd, const function<void()> &onBlock,
+                                           R alpha)
+{
+    const size_t m = b.getCols();
+    const size_t inner = a.getCols();
+    const size_t ldc = c.getStride();
+
+    for (size_t jj = 0; jj < m; jj += colBlock)
+    {
+        const size_t nc = min(colBlock, m - jj);
+        for (size_t kk = 0; kk < inner; kk += innerBlock)
+        {
+            const size_t kc = min(innerBlock, inner - kk);
+            packB(b, kk, kc, jj, nc);
+
+            for (size_t ii = rowBegin; ii < rowEnd; ii += rowBlock)
+            {
+                const size_t mc = min(rowBlock, rowEnd - ii);
+                packA(a, ii, mc, kk, kc);
+
+                for (size_t j = 0; j < nc; j += NR)
+                {
+                    const R *bPanel = packedB.data() + (j / NR) * NR * kc;
+                    for (size_t i = 0; i < mc; i += MR)
+                    {
+                        const R *aPanel = packedA.data() + (i / MR) * MR * kc;
+                        kernel(kc, aPanel, bPanel, c.rowPtr(ii + i) + jj + j, ldc,
+                               min(MR, mc - i), min(NR, nc - j), alpha);
+                    }
+                }
+                if (onBlock)
+                {
+                    onBlock();
+                }
+            }
+        }
+    }
+}
@@ -1,106 +1,410 @@
 #pragma once
 #include "MatrixMultiplier.h"
+#include "ThreadPool.h"
+#include "PackedKernel.h"
+#include "PerfCounters.h"
+#include "KSplitMultiplier.h"
 #include <thread>
+#include <memory>
 #include <stdexcept>
+#include <cstring>
+#include <utility>
 
 /**
  * @brief Parallel implementation of matrix multiplication
  *
  * This class implements matrix multiplication using multiple threads.
  * The matrix is divided into horizontal strips, with each strip being
- * processed by a separate thread. The number of threads can be specified
- * at construction time.
+ * processed as a separate task. The tasks run on a long-lived ThreadPool,
+ * so repeated multiply() calls reuse the same threads. The pool is either
+ * owned by the multiplier or shared between several of them.
+ * With packing enabled every strip runs through its own PackedKernel, whose
+ * buffers are reused by later calls.
+ *
+ * On a pool with pinned workers (see PinningPolicy) the multiplier is NUMA
+ * aware: strip i always runs on worker i, and the result is zero-filled by
+ * the strip that computes it, so its pages land on that worker's node.
+ * makeLeftOperand() and makeRightOperand() create inputs whose pages are
+ * placed the same way.
+ *
+ * Products with few rows but a long shared dimension (see
+ * KSplitMultiplier::suits()) leave most strips empty; they are handed to
+ * a KSplitMultiplier on the same pool, which splits the shared dimension.
+ *
+ * With setCounting() enabled every strip reads the hardware counters of
+ * the worker running it, so getStripCounters() breaks the last call down
+ * per strip (see PerfCounters); a product handed to the K-split strategy
+ * is broken down per part instead.
+ *
+ * @tparam T Element type of the input matrices
+ * @tparam R Accumulation type, also the element type of the result
  */
-class ParallelMultiplier : public MatrixMultiplier
+template <typename T, typename R = typename DefaultAccumulator<T>::type>
+class BasicParallelMultiplier : public BasicMatrixMultiplier<T, R>
 {
 private:
-    size_t numThreads; // Number of threads to use for multiplication
+    size_t numThreads;                       // Number of strips (tasks) per multiplication
+    shared_ptr<ThreadPool> pool;             // Workers executing the strips
+    bool packed;                             // Whether strips use the packed kernel
+    vector<BasicPackedKernel<T, R>> kernels; // One set of packing buffers per strip
+    bool local;                              // Whether strip i is bound to worker i and first-touches its rows
+    bool counting;                           // Whether strips read the hardware counters of their worker
+    vector<PerfSample> stripCounters;        // Counters of every strip of the last call
+    unique_ptr<BasicKSplitMultiplier<T, R>> kSplit; // Takes over products too short for row strips
+
+    /**
+     * @brief Gets the rows of one strip
+     * @param rows Number of rows being split
+     * @param strip Index of the strip
+     * @return pair<size_t, size_t> - first and past-the-end row
+     */
+    pair<size_t, size_t> stripRows(size_t rows, size_t strip) const;
+
+    /**
+     * @brief Creates a zero matrix whose pages are first written by the pool workers
+     * @param rows Number of rows
+     * @param cols Number of columns
+     * @param interleaved Deal out page-sized groups of rows round-robin instead of in strips
+     */
+    template <typename U>
+    BasicMatrix<U> makeTouched(size_t rows, size_t cols, bool interleaved);
 
     /**
-     * @brief Multiplies a portion of matrices
+     * @brief Adds the product of a portion of matrices to the result
      * @param a First matrix
      * @param b Second matrix
      * @param result Output matrix to store results
      * @param startRow Starting row for this thread's work
      * @param endRow Ending row (exclusive) for this thread's work
+     * @param alpha Scale applied to the product before it is added
+     */
+    void multiplyRange(const BasicMatrix<T> &a, const BasicMatrix<T> &b, BasicMatrix<R> &result,
+                       size_t startRow, size_t endRow, R alpha);
+
+protected:
+    /**
+     * @brief Multiplies two matrices in parallel into a caller-owned output
+     * @param a First matrix
+     * @param b Second matrix
+     * @param out Receives (or accumulates) the product
+     * @param mode Overwrite out or add the product to it
+     * @param alpha Scale applied to the product
      */
-    void multiplyRange(const Matrix &a, const Matrix &b, Matrix &result,
-                       size_t startRow, size_t endRow);
+    void compute(const BasicMatrix<T> &a, const BasicMatrix<T> &b, BasicMatrix<R> &out,
+                 Accumulate mode, R alpha) override;
 
 public:
     /**
-     * @brief Construct a new Parallel Multiplier object
+     * @brief Construct a new Parallel Multiplier object with its own thread pool
      *
-     * @param numThreads
+     * @param numThreads Number of worker threads (and strips)
+     * @param packed Pack A and B into panels inside every strip
+     * @param pinning Placement of the workers; anything but None makes the multiplier NUMA aware
+     * @throw std::invalid_argument if numThreads is zero
      */
-    explicit ParallelMultiplier(size_t numThreads = thread::hardware_concurrency());
+    explicit BasicParallelMultiplier(size_t numThreads = ThreadPool::defaultSize(), bool packed = false,
+                                     PinningPolicy pinning = PinningPolicy::None);
 
     /**
-     * @brief Multiplies two matrices in parallel
-     * @param a First matrix
-     * @param b Second matrix
-     * @return Matrix - result of matrix multiplication
+     * @brief Construct a new Parallel Multiplier object running on a shared pool
+     *
+     * The multiplier is NUMA aware if the workers of the pool are pinned.
+     *
+     * @param pool Pool to run the strips on, may be shared with other multipliers
+     * @param numThreads Number of strips, 0 means one per pool worker
+     * @param packed Pack A and B into panels inside every strip
+     * @throw std::invalid_argument if pool is null
+     */
+    explicit BasicParallelMultiplier(shared_ptr<ThreadPool> pool, size_t numThreads = 0, bool packed = false);
+
+    /**
+     * @brief Enables or disables operand packing
+     * @param enabled true to use the packed kernel on the next calls
      */
-    Matrix multiply(const Matrix &a, const Matrix &b) override;
+    void setPacking(bool enabled) { packed = enabled; }
+
+    /**
+     * @brief Sets the block sizes of the packed kernels of all strips
+     * @param rowBlock Rows of A per packed block
+     * @param innerBlock Shared dimension per packed block
+     * @param colBlock Columns of B per packed block
+     * @throw std::invalid_argument if any block size is zero
+     */
+    void setBlockSizes(size_t rowBlock, size_t innerBlock, size_t colBlock)
+    {
+        kernels.assign(numThreads, BasicPackedKernel<T, R>(rowBlock, innerBlock, colBlock));
+    }
+
+    /**
+     * @brief Enables or disables hardware counters per strip (or per part of a K-split product)
+     * @param enabled true to measure every strip of the next calls
+     */
+    void setCounting(bool enabled)
+    {
+        counting = enabled;
+        kSplit->setCounting(enabled);
+    }
+
+    /**
+     * @brief Gets the hardware counters of every strip of the last call
+     *
+     * Empty if counting is disabled; a strip without rows, or one run where
+     * perf_event_open is unavailable, has no counters present. If the last
+     * product was handed to the K-split strategy, these are the counters of
+     * its parts (see KSplitMultiplier::getPartCounters()).
+     *
+     * @return const vector<PerfSample>& - one entry per strip or part
+     */
+    const vector<PerfSample> &getStripCounters() const { return stripCounters; }
+
+    /**
+     * @brief Gets the pool the strips are executed on
+     * @return shared_ptr<ThreadPool>
+     */
+    shared_ptr<ThreadPool> getPool() const { return pool; }
+
+    /**
+     * @brief Checks whether strips are bound to workers and first-touch their memory
+     * @return true if the pool workers are pinned
+     */
+    bool isNumaAware() const { return local; }
+
+    /**
+     * @brief Creates a zero first operand laid out for this multiplier
+     *
+     * Row strips are first written by the workers that will read them in
+     * multiply(), so on a NUMA aware multiplier every strip of A is local to
+     * its worker. Fill it in place (e.g. with at()) to keep the placement.
+     *
+     * @param rows Number of rows
+     * @param cols Number of columns
+     * @return BasicMatrix<T> - zero matrix
+     */
+    BasicMatrix<T> makeLeftOperand(size_t rows, size_t cols) { return makeTouched<T>(rows, cols, false); }
+
+    /**
+     * @brief Creates a zero second operand laid out for this multiplier
+     *
+     * Every strip reads all of B, so no placement makes it local to every
+     * worker; instead its pages are dealt out round-robin over the workers,
+     * which spreads the reads over the memory controllers of all nodes.
+     *
+     * @param rows Number of rows
+     * @param cols Number of columns
+     * @return BasicMatrix<T> - zero matrix
+     */
+    BasicMatrix<T> makeRightOperand(size_t rows, size_t cols) { return makeTouched<T>(rows, cols, true); }
 
     /**
      * @brief Gets the name of the multiplication algorithm
-     * @return  const char* - "Parallel" as the algorithm identifier
+     * @return  const char* - "Parallel", with the packing and the pinning policy in parentheses
      */
-    const char *getName() const override { return "Parallel"; }
+    const char *getName() const override;
 };
 
-ParallelMultiplier::ParallelMultiplier(size_t numThreads)
-    : numThreads(numThreads) {}
+template <typename T, typename R>
+BasicParallelMultiplier<T, R>::BasicParallelMultiplier(size_t numThreads, bool packed, PinningPolicy pinning)
+    : numThreads(numThreads), packed(packed), local(pinning != PinningPolicy::None), counting(false)
+{
+    if (numThreads == 0)
+    {
+        throw std::invalid_argument("Number of threads must be positive");
+    }
+    pool = make_shared<ThreadPool>(numThreads, pinning);
+    kernels.resize(numThreads);
+    kSplit = make_unique<BasicKSplitMultiplier<T, R>>(pool, numThreads);
+}
+
+template <typename T, typename R>
+BasicParallelMultiplier<T, R>::BasicParallelMultiplier(shared_ptr<ThreadPool> pool, size_t numThreads, bool packed)
+    : numThreads(numThreads), pool(std::move(pool)), packed(packed), local(false), counting(false)
+{
+    if (!this->pool)
+    {
+        throw std::invalid_argument("Thread pool must not be null");
+    }
+    if (this->numThreads == 0)
+    {
+        this->numThreads = this->pool->size();
+    }
+    local = this->pool->getPinning() != PinningPolicy::None;
+    kernels.resize(this->numThreads);
+    kSplit = make_unique<BasicKSplitMultiplier<T, R>>(this->pool, this->numThreads);
+}
+
+template <typename T, typename R>
+const char *BasicParallelMultiplier<T, R>::getName() const
+{
+    switch (pool->getPinning())
+    {
+    case PinningPolicy::Compact:
+        return packed ? "Parallel (packed, compact)" : "Parallel (compact)";
+    case PinningPolicy::Scatter:
+        return packed ? "Parallel (packed, scatter)" : "Parallel (scatter)";
+    default:
+        return packed ? "Parallel (packed)" : "Parallel";
+    }
+}
+
+template <typename T, typename R>
+pair<size_t, size_t> BasicParallelMultiplier<T, R>::stripRows(size_t rows, size_t strip) const
+{
+    const size_t rowsPerThread = rows / numThreads;
+    const size_t remainingRows = rows % numThreads;
+    const size_t begin = strip * rowsPerThread + min(strip, remainingRows);
+    return {begin, begin + rowsPerThread + (strip < remainingRows ? 1 : 0)};
+}
 
-void ParallelMultiplier::multiplyRange(const Matrix &a, const Matrix &b,
-                                       Matrix &result, size_t startRow, size_t endRow)
+template <typename T, typename R>
+template <typename U>
+BasicMatrix<U> BasicParallelMultiplier<T, R>::makeTouched(size_t rows, size_t cols, bool interleaved)
+{
+    BasicMatrix<U> m = BasicMatrix<U>::makeUninitialized(rows, cols);
+    if (rows == 0 || cols == 0)
+    {
+        return m;
+    }
+
+    const size_t rowBytes = m.getStride() * sizeof(U);
+    const size_t rowsPerPage = max<size_t>(1, 4096 / rowBytes);
+    // worker i writes the rows it owns, and so becomes the node they are placed on
+    auto touchRows = [this, &m, rows, rowBytes, rowsPerPage, interleaved](size_t i)
+    {
+        if (interleaved)
+        {
+            for (size_t r = i * rowsPerPage; r < rows; r += numThreads * rowsPerPage)
+            {
+                memset(m.rowPtr(r), 0, min(rowsPerPage, rows - r) * rowBytes);
+            }
+            return;
+        }
+        const auto [begin, end] = stripRows(rows, i);
+        if (begin < end)
+        {
+            memset(m.rowPtr(begin), 0, (end - begin) * rowBytes);
+        }
+    };
+
+    vector<future<void>> touches;
+    for (size_t i = 0; i < numThreads; ++i)
+    {
+        touches.push_back(pool->submitTo(i, [&touchRows, i]
+                                         { touchRows(i); }));
+    }
+    for (auto &touch : touches)
+    {
+        touch.get();
+    }
+    return m;
+}
+
+template <typename T, typename R>
+void BasicParallelMultiplier<T, R>::multiplyRange(const BasicMatrix<T> &a, const BasicMatrix<T> &b,
+                                                  BasicMatrix<R> &result, size_t startRow, size_t endRow, R alpha)
 {
     for (size_t i = startRow; i < endRow; ++i)
     {
         for (size_t j = 0; j < b.getCols(); ++j)
         {
-            double sum = 0.0;
+            R sum = R(0);
             for (size_t k = 0; k < a.getCols(); ++k)
             {
-                sum += a.at(i, k) * b.at(k, j);
+                sum += static_cast<R>(a.at(i, k)) * static_cast<R>(b.at(k, j));
             }
-            result.at(i, j) = sum;
+            result.at(i, j) += alpha * sum;
         }
+        this->finishTile();
     }
 }
 
-Matrix ParallelMultiplier::multiply(const Matrix &a, const Matrix &b)
+template <typename T, typename R>
+void BasicParallelMultiplier<T, R>::compute(const BasicMatrix<T> &a, const BasicMatrix<T> &b,
+                                            BasicMatrix<R> &out, Accumulate mode, R alpha)
 {
-    validateMatrices(a, b);
-
-    Matrix result(a.getRows(), b.getCols());
-    vector<thread> threads;
+    this->validateOutput(a, b, out, mode);
+    if (BasicKSplitMultiplier<T, R>::suits(a.getRows(), a.getCols(), b.getCols(), numThreads))
+    {
+        stripCounters.clear();
+        this->delegateInto(*kSplit, a, b, out, mode, alpha);
+        stripCounters = kSplit->getPartCounters();
+        return;
+    }
 
-    // calculate rows per thread
-    size_t rowsPerThread = a.getRows() / numThreads;
-    size_t remainingRows = a.getRows() % numThreads;
+    // strips zero their own rows, in parallel and, when NUMA aware, on their worker's node
+    bool zeroRows = mode == Accumulate::Overwrite;
+    if (zeroRows && (out.getRows() != a.getRows() || out.getCols() != b.getCols()))
+    {
+        if (local)
+        {
+            out = BasicMatrix<R>::makeUninitialized(a.getRows(), b.getCols());
+        }
+        else
+        {
+            out.resize(a.getRows(), b.getCols()); // zero-filled, reusing the storage
+            zeroRows = false;
+        }
+    }
+    vector<future<void>> strips;
+    stripCounters.assign(counting ? numThreads : 0, PerfSample());
 
-    size_t startRow = 0;
+    // tiles are the packed blocks of every strip, or single rows without packing
+    size_t tiles = a.getRows();
+    if (packed)
+    {
+        tiles = 0;
+        for (size_t i = 0; i < numThreads; ++i)
+        {
+            const auto [startRow, endRow] = stripRows(a.getRows(), i);
+            tiles += kernels[i].blockCount(endRow - startRow, a.getCols(), b.getCols());
+        }
+    }
+    this->startTiles(tiles);
 
-    // create and launch threads
+    // queue one task per strip
     for (size_t i = 0; i < numThreads; ++i)
     {
-        size_t threadRows = rowsPerThread + (i < remainingRows ? 1 : 0);
-        size_t endRow = startRow + threadRows;
-
-        threads.emplace_back(&ParallelMultiplier::multiplyRange, this,
-                             ref(a), ref(b), ref(result),
-                             startRow, endRow);
+        const auto [startRow, endRow] = stripRows(a.getRows(), i);
+        if (startRow == endRow)
+        {
+            continue;
+        }
 
-        startRow = endRow;
+        auto strip = [this, i, zeroRows, alpha, &a, &b, &out, startRow = startRow, endRow = endRow]
+        {
+            const PerfSample before = counting ? PerfCounters::forThisThread().read() : PerfSample();
+            if (zeroRows)
+            {
+                memset(out.rowPtr(startRow), 0, (endRow - startRow) * out.getStride() * sizeof(R));
+            }
+            if (packed)
+            {
+                kernels[i].multiplyRows(a, b, out, startRow, endRow, [this]
+                                        { this->finishTile(); }, alpha);
+            }
+            else
+            {
+                multiplyRange(a, b, out, startRow, endRow, alpha);
+            }
+            if (counting)
+            {
+                stripCounters[i] = PerfCounters::forThisThread().read() - before;
+            }
+        };
+        strips.push_back(local ? pool->submitTo(i, std::move(strip)) : pool->submit(std::move(strip)));
     }
 
-    // wait for all threads to complete
-    for (auto &thread : threads)
-    {
-        thread.join();
-    }
+    // wait for all strips to complete, even if one of them failed or was cancelled
+    ThreadPool::waitAll(strips);
+}
+
+/**
+ * @brief Parallel multiplier of double matrices
+ */
+using ParallelMultiplier = BasicParallelMultiplier<double>;
 
-    return result;
-}
\ No newline at end of file
+template class BasicParallelMultiplier<float>;
+template class BasicParallelMultiplier<double>;
+template class BasicParallelMultiplier<int32_t>;
+template class BasicParallelMultiplier<int64_t>;
+template class BasicParallelMultiplier<int8_t, int32_t>;
+template class BasicParallelMultiplier<int16_t, int32_t>;
@@ -0,0 +1,231 @@
+#pragma once
+#include "SparseMultiplier.h"
+#include "ThreadPool.h"
+#include <thread>
+#include <memory>
+#include <stdexcept>
+
+/**
+ * @brief Parallel implementation of the sparse products
+ *
+ * The compressed rows (or columns for a CSC SpMV) are split into one strip
+ * per thread. Strip boundaries are chosen so that every strip holds about
+ * the same number of non-zeros rather than the same number of rows, which
+ * keeps the work balanced on matrices with a few very dense rows. The strips
+ * run on a ThreadPool that is either owned or shared, as in ParallelMultiplier.
+ *
+ * A CSC SpMV scatters into y, so every strip accumulates into its own vector
+ * and the vectors are summed afterwards, again in parallel.
+ *
+ * @tparam T Element type of the matrices
+ */
+template <typename T>
+class BasicParallelSparseMultiplier : public BasicSparseMultiplier<T>
+{
+private:
+    size_t numThreads;           // Number of strips per product
+    shared_ptr<ThreadPool> pool; // Workers executing the strips
+
+    /**
+     * @brief Splits the compressed dimension into strips of balanced non-zero counts
+     * @param offsets Offsets array of the matrix
+     * @return vector<size_t> - numThreads + 1 strip boundaries
+     */
+    vector<size_t> partition(const vector<size_t> &offsets) const;
+
+    /**
+     * @brief Runs task(strip, begin, end) for every non-empty strip and waits for them
+     */
+    template <typename Task>
+    void runStrips(const vector<size_t> &bounds, Task task);
+
+public:
+    /**
+     * @brief Construct a new Parallel Sparse Multiplier object with its own thread pool
+     * @param numThreads Number of worker threads (and strips)
+     * @throw std::invalid_argument if numThreads is zero
+     */
+    explicit BasicParallelSparseMultiplier(size_t numThreads = ThreadPool::defaultSize());
+
+    /**
+     * @brief Construct a new Parallel Sparse Multiplier object running on a shared pool
+     * @param pool Pool to run the strips on
+     * @param numThreads Number of strips, 0 means one per pool worker
+     * @throw std::invalid_argument if pool is null
+     */
+    explicit BasicParallelSparseMultiplier(shared_ptr<ThreadPool> pool, size_t numThreads = 0);
+
+    /**
+     * @brief Multiplies a sparse matrix by a dense vector (SpMV) in parallel
+     * @param a Sparse matrix, CSR or CSC
+     * @param x Vector of a.getCols() elements
+     * @return vector<T> - a * x
+     */
+    vector<T> multiply(const BasicSparseMatrix<T> &a, const vector<T> &x) override;
+
+    /**
+     * @brief Multiplies a sparse matrix by a dense matrix (SpMM) in parallel
+     * @param a Sparse matrix
+     * @param b Dense matrix
+     * @return BasicMatrix<T> - dense result
+     */
+    BasicMatrix<T> multiply(const BasicSparseMatrix<T> &a, const BasicMatrix<T> &b) override;
+
+    /**
+     * @brief Multiplies two sparse matrices (SpGEMM) in parallel
+     * @param a First sparse matrix
+     * @param b Second sparse matrix
+     * @return BasicSparseMatrix<T> - sparse result in CSR
+     */
+    BasicSparseMatrix<T> multiply(const BasicSparseMatrix<T> &a, const BasicSparseMatrix<T> &b) override;
+
+    /**
+     * @brief Gets the name of the multiplication algorithm
+     * @return const char* - "Sparse parallel" as the algorithm identifier
+     */
+    const char *getName() const override { return "Sparse parallel"; }
+};
+
+template <typename T>
+BasicParallelSparseMultiplier<T>::BasicParallelSparseMultiplier(size_t numThreads)
+    : numThreads(numThreads)
+{
+    if (numThreads == 0)
+    {
+        throw std::invalid_argument("Number of threads must be positive");
+    }
+    pool = make_shared<ThreadPool>(numThreads);
+}
+
+template <typename T>
+BasicParallelSparseMultiplier<T>::BasicParallelSparseMultiplier(shared_ptr<ThreadPool> pool, size_t numThreads)
+    : numThreads(numThreads), pool(std::move(pool))
+{
+    if (!this->pool)
+    {
+        throw std::invalid_argument("Thread pool must not be null");
+    }
+    if (this->numThreads == 0)
+    {
+        this->numThreads = this->pool->size();
+    }
+}
+
+template <typename T>
+vector<size_t> BasicParallelSparseMultiplier<T>::partition(const vector<size_t> &offsets) const
+{
+    const size_t major = offsets.size() - 1;
+    const size_t total = offsets.back();
+
+    vector<size_t> bounds(numThreads + 1, major);
+    bounds[0] = 0;
+    for (size_t s = 1; s < numThreads; ++s)
+    {
+        // first row whose non-zeros start at or after this strip's share; empty matrices split by rows
+        const size_t target = total == 0 ? major * s / numThreads : total * s / numThreads;
+        const size_t row = total == 0 ? target
+                                      : lower_bound(offsets.begin(), offsets.end(), target) - offsets.begin();
+        bounds[s] = max(bounds[s - 1], min(row, major));
+    }
+    return bounds;
+}
+
+template <typename T>
+template <typename Task>
+void BasicParallelSparseMultiplier<T>::runStrips(const vector<size_t> &bounds, Task task)
+{
+    vector<future<void>> strips;
+    for (size_t s = 0; s + 1 < bounds.size(); ++s)
+    {
+        if (bounds[s] < bounds[s + 1])
+        {
+            strips.push_back(pool->submit([&task, s, &bounds]
+                                          { task(s, bounds[s], bounds[s + 1]); }));
+        }
+    }
+    // every strip refers to task and bounds, so all of them finish before an exception leaves this frame
+    ThreadPool::waitAll(strips);
+}
+
+template <typename T>
+vector<T> BasicParallelSparseMultiplier<T>::multiply(const BasicSparseMatrix<T> &a, const vector<T> &x)
+{
+    if (x.size() != a.getCols())
+    {
+        throw std::invalid_argument("Vector length does not match the number of columns");
+    }
+
+    vector<T> y(a.getRows(), T(0));
+    const vector<size_t> bounds = partition(a.getOffsets());
+
+    if (a.getFormat() == SparseFormat::CSR)
+    {
+        runStrips(bounds, [&](size_t, size_t begin, size_t end)
+                  { this->spmvRows(a, x.data(), y.data(), begin, end); });
+        return y;
+    }
+
+    // CSC: private accumulators per strip, then a parallel sum over row ranges
+    vector<vector<T>> partial(numThreads);
+    runStrips(bounds, [&](size_t s, size_t begin, size_t end)
+              {
+        partial[s].assign(a.getRows(), T(0));
+        this->spmvColumns(a, x.data(), partial[s].data(), begin, end); });
+
+    vector<size_t> rowBounds(numThreads + 1);
+    for (size_t s = 0; s <= numThreads; ++s)
+    {
+        rowBounds[s] = a.getRows() * s / numThreads;
+    }
+    runStrips(rowBounds, [&](size_t, size_t begin, size_t end)
+              {
+        for (const vector<T> &p : partial)
+        {
+            if (!p.empty())
+            {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    y[i] += p[i];
+                }
+            }
+        } });
+    return y;
+}
+
+template <typename T>
+BasicMatrix<T> BasicParallelSparseMultiplier<T>::multiply(const BasicSparseMatrix<T> &a, const BasicMatrix<T> &b)
+{
+    this->validateDimensions(a.getRows(), a.getCols(), b.getRows(), b.getCols());
+
+    BasicSparseMatrix<T> converted(0, 0);
+    const BasicSparseMatrix<T> &csr = this->asCsr(a, converted);
+    BasicMatrix<T> result(a.getRows(), b.getCols());
+    runStrips(partition(csr.getOffsets()), [&](size_t, size_t begin, size_t end)
+              { this->spmmRows(csr, b, result, begin, end); });
+    return result;
+}
+
+template <typename T>
+BasicSparseMatrix<T> BasicParallelSparseMultiplier<T>::multiply(const BasicSparseMatrix<T> &a,
+                                                                 const BasicSparseMatrix<T> &b)
+{
+    this->validateDimensions(a.getRows(), a.getCols(), b.getRows(), b.getCols());
+
+    BasicSparseMatrix<T> convertedA(0, 0), convertedB(0, 0);
+    const BasicSparseMatrix<T> &csrA = this->asCsr(a, convertedA);
+    const BasicSparseMatrix<T> &csrB = this->asCsr(b, convertedB);
+
+    // strips are contiguous row ranges, so their parts are concatenated in strip order
+    vector<typename BasicSparseMultiplier<T>::RowsProduct> parts(numThreads);
+    runStrips(partition(csrA.getOffsets()), [&](size_t s, size_t begin, size_t end)
+              { parts[s] = this->spgemmRows(csrA, csrB, begin, end); });
+    return this->assemble(a.getRows(), b.getCols(), parts);
+}
+
+/**
+ * @brief Parallel sparse multiplier of double matrices
+ */
+using ParallelSparseMultiplier = BasicParallelSparseMultiplier<double>;
+
+template class BasicParallelSparseMultiplier<float>;
+template class BasicParallelSparseMultiplier<double>;
@@ -0,0 +1,300 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/**
+ * @brief Hardware events counted by PerfCounters
+ */
+enum PerfEvent
+{
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,   // L1 data cache read misses
+    PERF_LLC_MISSES,   // last-level cache read misses
+    PERF_BRANCH_MISSES,
+    PERF_EVENT_COUNT
+};
+
+/**
+ * @brief Values of the hardware counters, for one interval of one thread or summed
+ *
+ * A counter the kernel or the CPU does not provide is marked as missing
+ * rather than reported as zero.
+ */
+struct PerfSample
+{
+    uint64_t values[PERF_EVENT_COUNT] = {};
+    bool present[PERF_EVENT_COUNT] = {};
+
+    /**
+     * @brief Checks whether any counter was measured
+     */
+    bool any() const;
+
+    /**
+     * @brief Gets the instructions per cycle
+     * @return double - 0 if cycles or instructions are missing
+     */
+    double ipc() const;
+
+    /**
+     * @brief Gets the counts of the interval between two readings
+     */
+    PerfSample operator-(const PerfSample &earlier) const;
+
+    /**
+     * @brief Adds the counts of another thread or interval
+     */
+    PerfSample &operator+=(const PerfSample &other);
+
+    /**
+     * @brief Divides every count, e.g. to average over repetitions
+     */
+    PerfSample &operator/=(uint64_t divisor);
+
+    /**
+     * @brief Gets the short name of an event, as used in reports
+     */
+    static const char *eventName(int event);
+};
+
+/**
+ * @brief Hardware performance counters of the calling thread, read through Linux perf_event_open
+ *
+ * The counters are opened once for the thread that constructs the object
+ * and count user-space events only, which the default perf_event_paranoid
+ * setting allows. Each event is opened on its own, so an event the CPU
+ * lacks (common in virtual machines) leaves the others working; if
+ * perf_event_open is not available at all (another OS, a container
+ * without the syscall, a stricter paranoid level) every reading is simply
+ * empty and callers keep their wall-clock timings. Values are scaled when
+ * the kernel had to multiplex the counters.
+ *
+ * Counters belong to a thread: use forThisThread() from the thread that is
+ * measured, and take the difference of two read() calls around the work.
+ */
+class PerfCounters
+{
+private:
+    int fds[PERF_EVENT_COUNT]; // one perf file descriptor per event, -1 if it could not be opened
+
+public:
+    /**
+     * @brief Construct a new Perf Counters object counting for the calling thread
+     */
+    PerfCounters();
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    /**
+     * @brief Closes the counters
+     */
+    ~PerfCounters();
+
+    /**
+     * @brief Checks whether at least one counter could be opened
+     * @return true if read() returns measurements
+     */
+    bool isAvailable() const;
+
+    /**
+     * @brief Reads the running totals of all counters
+     * @return PerfSample - totals since the counters were opened
+     */
+    PerfSample read() const;
+
+    /**
+     * @brief Gets the counters of the calling thread, opened on first use
+     * @return PerfCounters& - one instance per thread, lives as long as the thread
+     */
+    static PerfCounters &forThisThread();
+};
+
+/**
+ * @brief Prints the counters as "cycles=... instr=... IPC=..."; missing ones as n/a
+ */
+ostream &operator<<(ostream &os, const PerfSample &sample);
+
+bool PerfSample::any() const
+{
+    for (bool p : present)
+    {
+        if (p)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+double PerfSample::ipc() const
+{
+    if (!present[PERF_CYCLES] || !present[PERF_INSTRUCTIONS] || values[PERF_CYCLES] == 0)
+    {
+        return 0.0;
+    }
+    return static_cast<double>(values[PERF_INSTRUCTIONS]) / values[PERF_CYCLES];
+}
+
+PerfSample PerfSample::operator-(const PerfSample &earlier) const
+{
+    PerfSample diff;
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e)
+    {
+        diff.present[e] = present[e] && earlier.present[e];
+        diff.values[e] = diff.present[e] && values[e] >= earlier.values[e] ? values[e] - earlier.values[e] : 0;
+    }
+    return diff;
+}
+
+PerfSample &PerfSample::operator+=(const PerfSample &other)
+{
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e)
+    {
+        if (other.present[e])
+        {
+            values[e] += other.values[e];
+            present[e] = true;
+        }
+    }
+    return *this;
+}
+
+PerfSample &PerfSample::operator/=(uint64_t divisor)
+{
+    for (uint64_t &value : values)
+    {
+        value /= divisor;
+    }
+    return *this;
+}
+
+const char *PerfSample::eventName(int event)
+{
+    static const char *const names[PERF_EVENT_COUNT] = {"cycles", "instr", "L1d-miss", "LLC-miss", "br-miss"};
+    return names[event];
+}
+
+PerfCounters::PerfCounters()
+{
+    for (int &fd : fds)
+    {
+        fd = -1;
+    }
+
+#ifdef __linux__
+    const uint64_t cacheReadMiss = (uint64_t(PERF_COUNT_HW_CACHE_OP_READ) << 8) |
+                                   (uint64_t(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16);
+    const struct
+    {
+        uint32_t type;
+        uint64_t config;
+    } events[PERF_EVENT_COUNT] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | cacheReadMiss},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | cacheReadMiss},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    };
+
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e)
+    {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = events[e].type;
+        attr.config = events[e].config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // pid 0, cpu -1: the calling thread on whichever cpu it runs
+        const long fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        fds[e] = fd < 0 ? -1 : static_cast<int>(fd);
+    }
+#endif
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+    for (int fd : fds)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+#endif
+}
+
+bool PerfCounters::isAvailable() const
+{
+    for (int fd : fds)
+    {
+        if (fd >= 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+PerfSample PerfCounters::read() const
+{
+    PerfSample sample;
+#ifdef __linux__
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e)
+    {
+        uint64_t data[3]; // value, time enabled, time running
+        if (fds[e] < 0 || ::read(fds[e], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)))
+        {
+            continue;
+        }
+        // a multiplexed counter ran only part of the time, extrapolate to the whole interval
+        const double scale = data[2] > 0 && data[2] < data[1] ? static_cast<double>(data[1]) / data[2] : 1.0;
+        sample.values[e] = static_cast<uint64_t>(data[0] * scale);
+        sample.present[e] = true;
+    }
+#endif
+    return sample;
+}
+
+PerfCounters &PerfCounters::forThisThread()
+{
+    thread_local PerfCounters counters;
+    return counters;
+}
+
+ostream &operator<<(ostream &os, const PerfSample &sample)
+{
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e)
+    {
+        os << (e ? " " : "") << PerfSample::eventName(e) << "=";
+        if (sample.present[e])
+        {
+            os << sample.values[e];
+        }
+        else
+        {
+            os << "n/a";
+        }
+    }
+    if (sample.ipc() > 0.0)
+    {
+        os << " IPC=" << fixed << setprecision(2) << sample.ipc();
+    }
+    return os;
+}
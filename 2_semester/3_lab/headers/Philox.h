@@ -0,0 +1,76 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+using namespace std;
+
+/**
+ * @brief Philox4x32-10 counter-based random number generator
+ *
+ * Unlike mt19937, which has to produce its numbers in sequence, Philox is a
+ * keyed bijection: the output for a 128-bit counter under a 64-bit key is
+ * computed directly, with ten rounds of multiplication and xor. Any number
+ * of threads can therefore generate any part of a stream independently,
+ * and the value at a position never depends on how the work was split.
+ * BasicMatrix::randomize() uses the row and column of an element as the
+ * counter and the seed as the key.
+ *
+ * Reference: Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3", SC'11.
+ */
+struct Philox4x32
+{
+    using Counter = array<uint32_t, 4>;
+    using Key = array<uint32_t, 2>;
+
+    static constexpr uint32_t M0 = 0xD2511F53; // round multipliers
+    static constexpr uint32_t M1 = 0xCD9E8D57;
+    static constexpr uint32_t W0 = 0x9E3779B9; // key schedule increments
+    static constexpr uint32_t W1 = 0xBB67AE85;
+    static constexpr int ROUNDS = 10;
+
+    /**
+     * @brief Computes the four random words of one counter
+     * @param counter Position in the stream
+     * @param key Stream selector (the seed)
+     * @return Counter - four independent uniformly distributed 32-bit words
+     */
+    static constexpr Counter generate(Counter counter, Key key)
+    {
+        for (int round = 0; round < ROUNDS; ++round)
+        {
+            if (round > 0)
+            {
+                key[0] += W0;
+                key[1] += W1;
+            }
+            const uint64_t p0 = uint64_t(M0) * counter[0];
+            const uint64_t p1 = uint64_t(M1) * counter[2];
+            counter = {uint32_t(p1 >> 32) ^ counter[1] ^ key[0], uint32_t(p1),
+                       uint32_t(p0 >> 32) ^ counter[3] ^ key[1], uint32_t(p0)};
+        }
+        return counter;
+    }
+
+    /**
+     * @brief Splits a 64-bit seed into a key
+     */
+    static constexpr Key makeKey(uint64_t seed) { return {uint32_t(seed), uint32_t(seed >> 32)}; }
+
+    /**
+     * @brief Maps 32 random bits to [0, 1)
+     */
+    static constexpr float toUnitFloat(uint32_t bits) { return float(bits >> 8) * (1.0f / 16777216.0f); }
+
+    /**
+     * @brief Maps 64 random bits to [0, 1)
+     */
+    static constexpr double toUnitDouble(uint32_t high, uint32_t low)
+    {
+        return double(((uint64_t(high) << 32) | low) >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    /**
+     * @brief Maps 32 random bits to 0 .. range-1 by multiplication, without a division
+     */
+    static constexpr uint32_t toRange(uint32_t bits, uint32_t range) { return uint32_t((uint64_t(bits) * range) >> 32); }
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include "MatrixMultiplier.h"
+#include "PackedKernel.h"
 #include <stdexcept>
 
 /**
@@ -7,44 +8,102 @@
  *
  * This class implements matrix multiplication using a standard sequential
  * algorithm. It serves as a baseline for comparing performance with
- * parallel implementations.
+ * parallel implementations. Optionally the operands are packed into
+ * contiguous panels first (see PackedKernel).
+ *
+ * @tparam T Element type of the input matrices
+ * @tparam R Accumulation type, also the element type of the result
  */
-class SequentialMultiplier : public MatrixMultiplier
+template <typename T, typename R = typename DefaultAccumulator<T>::type>
+class BasicSequentialMultiplier : public BasicMatrixMultiplier<T, R>
 {
-public:
+private:
+    bool packed;                    // whether to use the packed kernel
+    BasicPackedKernel<T, R> kernel; // packing buffers, reused across calls
+
+protected:
     /**
-     * @brief Multiplies two matrices sequentially
+     * @brief Multiplies two matrices sequentially into a caller-owned output
      * @param a First matrix
      * @param b Second matrix
-     * @return Matrix - result of matrix multiplication
+     * @param out Receives (or accumulates) the product
+     * @param mode Overwrite out or add the product to it
+     * @param alpha Scale applied to the product
+     */
+    void compute(const BasicMatrix<T> &a, const BasicMatrix<T> &b, BasicMatrix<R> &out,
+                 Accumulate mode, R alpha) override;
+
+public:
+    /**
+     * @brief Construct a new Sequential Multiplier object
+     * @param packed Pack A and B into panels instead of the plain triple loop
+     */
+    explicit BasicSequentialMultiplier(bool packed = false) : packed(packed) {}
+
+    /**
+     * @brief Enables or disables operand packing
+     * @param enabled true to use the packed kernel on the next calls
      */
-    Matrix multiply(const Matrix &a, const Matrix &b) override;
+    void setPacking(bool enabled) { packed = enabled; }
+
+    /**
+     * @brief Sets the block sizes of the packed kernel
+     * @param rowBlock Rows of A per packed block
+     * @param innerBlock Shared dimension per packed block
+     * @param colBlock Columns of B per packed block
+     * @throw std::invalid_argument if any block size is zero
+     */
+    void setBlockSizes(size_t rowBlock, size_t innerBlock, size_t colBlock)
+    {
+        kernel = BasicPackedKernel<T, R>(rowBlock, innerBlock, colBlock);
+    }
 
     /**
      * @brief Gets the name of the multiplication algorithm
      * @return  const char* - "Sequential" as the algorithm identifier
      */
-    const char *getName() const override { return "Sequential"; }
+    const char *getName() const override { return packed ? "Sequential (packed)" : "Sequential"; }
 };
 
-Matrix SequentialMultiplier::multiply(const Matrix &a, const Matrix &b)
+template <typename T, typename R>
+void BasicSequentialMultiplier<T, R>::compute(const BasicMatrix<T> &a, const BasicMatrix<T> &b,
+                                              BasicMatrix<R> &out, Accumulate mode, R alpha)
 {
-    validateMatrices(a, b);
+    this->prepareOutput(a, b, out, mode);
 
-    Matrix result(a.getRows(), b.getCols());
+    if (packed)
+    {
+        this->startTiles(kernel.blockCount(a.getRows(), a.getCols(), b.getCols()));
+        kernel.multiplyRows(a, b, out, 0, a.getRows(), [this]
+                            { this->finishTile(); }, alpha);
+        return;
+    }
 
+    // every row of C is one tile
+    this->startTiles(a.getRows());
     for (size_t i = 0; i < a.getRows(); ++i)
     {
         for (size_t j = 0; j < b.getCols(); ++j)
         {
-            double sum = 0.0;
+            R sum = R(0);
             for (size_t k = 0; k < a.getCols(); ++k)
             {
-                sum += a.at(i, k) * b.at(k, j);
+                sum += static_cast<R>(a.at(i, k)) * static_cast<R>(b.at(k, j));
             }
-            result.at(i, j) = sum;
+            out.at(i, j) += alpha * sum;
         }
+        this->finishTile();
     }
+}
+
+/**
+ * @brief Sequential multiplier of double matrices
+ */
+using SequentialMultiplier = BasicSequentialMultiplier<double>;
 
-    return result;
-}
\ No newline at end of file
+template class BasicSequentialMultiplier<float>;
+template class BasicSequentialMultiplier<double>;
+template class BasicSequentialMultiplier<int32_t>;
+template class BasicSequentialMultiplier<int64_t>;
+template class BasicSequentialMultiplier<int8_t, int32_t>;
+template class BasicSequentialMultiplier<int16_t, int32_t>;
@@ -0,0 +1,99 @@
+#pragma once
+#include "SparseMultiplier.h"
+
+/**
+ * @brief Sequential implementation of the sparse products
+ *
+ * Runs the shared row kernels over all rows on the calling thread. It is
+ * the baseline for ParallelSparseMultiplier.
+ *
+ * @tparam T Element type of the matrices
+ */
+template <typename T>
+class BasicSequentialSparseMultiplier : public BasicSparseMultiplier<T>
+{
+public:
+    /**
+     * @brief Multiplies a sparse matrix by a dense vector (SpMV)
+     * @param a Sparse matrix, CSR or CSC
+     * @param x Vector of a.getCols() elements
+     * @return vector<T> - a * x
+     */
+    vector<T> multiply(const BasicSparseMatrix<T> &a, const vector<T> &x) override;
+
+    /**
+     * @brief Multiplies a sparse matrix by a dense matrix (SpMM)
+     * @param a Sparse matrix
+     * @param b Dense matrix
+     * @return BasicMatrix<T> - dense result
+     */
+    BasicMatrix<T> multiply(const BasicSparseMatrix<T> &a, const BasicMatrix<T> &b) override;
+
+    /**
+     * @brief Multiplies two sparse matrices (SpGEMM)
+     * @param a First sparse matrix
+     * @param b Second sparse matrix
+     * @return BasicSparseMatrix<T> - sparse result in CSR
+     */
+    BasicSparseMatrix<T> multiply(const BasicSparseMatrix<T> &a, const BasicSparseMatrix<T> &b) override;
+
+    /**
+     * @brief Gets the name of the multiplication algorithm
+     * @return const char* - "Sparse sequential" as the algorithm identifier
+     */
+    const char *getName() const override { return "Sparse sequential"; }
+};
+
+template <typename T>
+vector<T> BasicSequentialSparseMultiplier<T>::multiply(const BasicSparseMatrix<T> &a, const vector<T> &x)
+{
+    if (x.size() != a.getCols())
+    {
+        throw std::invalid_argument("Vector length does not match the number of columns");
+    }
+
+    vector<T> y(a.getRows(), T(0));
+    if (a.getFormat() == SparseFormat::CSR)
+    {
+        this->spmvRows(a, x.data(), y.data(), 0, a.getRows());
+    }
+    else
+    {
+        this->spmvColumns(a, x.data(), y.data(), 0, a.getCols());
+    }
+    return y;
+}
+
+template <typename T>
+BasicMatrix<T> BasicSequentialSparseMultiplier<T>::multiply(const BasicSparseMatrix<T> &a, const BasicMatrix<T> &b)
+{
+    this->validateDimensions(a.getRows(), a.getCols(), b.getRows(), b.getCols());
+
+    BasicSparseMatrix<T> converted(0, 0);
+    const BasicSparseMatrix<T> &csr = this->asCsr(a, converted);
+    BasicMatrix<T> result(a.getRows(), b.getCols());
+    this->spmmRows(csr, b, result, 0, csr.getRows());
+    return result;
+}
+
+template <typename T>
+BasicSparseMatrix<T> BasicSequentialSparseMultiplier<T>::multiply(const BasicSparseMatrix<T> &a,
+                                                                   const BasicSparseMatrix<T> &b)
+{
+    this->validateDimensions(a.getRows(), a.getCols(), b.getRows(), b.getCols());
+
+    BasicSparseMatrix<T> convertedA(0, 0), convertedB(0, 0);
+    const BasicSparseMatrix<T> &csrA = this->asCsr(a, convertedA);
+    const BasicSparseMatrix<T> &csrB = this->asCsr(b, convertedB);
+    vector<typename BasicSparseMultiplier<T>::RowsProduct> parts;
+    parts.push_back(this->spgemmRows(csrA, csrB, 0, csrA.getRows()));
+    return this->assemble(a.getRows(), b.getCols(), parts);
+}
+
+/**
+ * @brief Sequential sparse multiplier of double matrices
+ */
+using SequentialSparseMultiplier = BasicSequentialSparseMultiplier<double>;
+
+template class BasicSequentialSparseMultiplier<float>;
+template class BasicSequentialSparseMultiplier<double>;
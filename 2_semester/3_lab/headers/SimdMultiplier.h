@@ -0,0 +1,379 @@
+#pragma once
+#include "MatrixMultiplier.h"
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MATRIX_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Instruction set used by the SIMD micro-kernel
+ */
+enum class SimdKernel
+{
+    Auto,   // pick the widest kernel the CPU supports
+    Scalar, // portable 4x4 register-blocked C++ kernel
+    AVX2,   // 6x8 doubles, AVX2 + FMA
+    AVX512  // 8x16 doubles, AVX-512F
+};
+
+/**
+ * @brief Matrix multiplication built on a register-blocked SIMD micro-kernel
+ *
+ * C is computed in small mr x nr tiles that live entirely in vector registers
+ * while the shared dimension is walked. The tiles are visited inside cache
+ * blocks of innerBlock x colBlock of B and rowBlock rows of A.
+ * The kernel is chosen at run time from the cpuid feature bits, so the same
+ * binary runs on machines without AVX2 by falling back to the scalar kernel.
+ * Edge tiles that do not fill a whole mr x nr block use the scalar code.
+ */
+class SimdMultiplier : public MatrixMultiplier
+{
+private:
+    // C[0..mr, 0..nr] += alpha * A[0..mr, 0..kc] * B[0..kc, 0..nr]
+    using MicroKernel = void (*)(size_t kc, const double *a, size_t lda,
+                                 const double *b, size_t ldb, double *c, size_t ldc, double alpha);
+
+    SimdKernel kernel;   // selected instruction set
+    MicroKernel micro;   // full-tile kernel for that instruction set
+    size_t mr;           // rows of a register tile
+    size_t nr;           // columns of a register tile
+    size_t rowBlock;     // rows of A per cache block
+    size_t innerBlock;   // shared dimension per cache block
+    size_t colBlock;     // columns of B per cache block
+
+    /**
+     * @brief Portable kernel for full 4x4 tiles, left to the compiler to vectorize
+     */
+    static void kernelScalar4x4(size_t kc, const double *a, size_t lda,
+                                const double *b, size_t ldb, double *c, size_t ldc, double alpha);
+
+    /**
+     * @brief Generic kernel for partial tiles at the right and bottom edges
+     */
+    static void kernelEdge(size_t kc, const double *a, size_t lda,
+                           const double *b, size_t ldb, double *c, size_t ldc,
+                           double alpha, size_t rows, size_t cols);
+
+#ifdef MATRIX_SIMD_X86
+    /**
+     * @brief 6x8 tile kernel: 12 ymm accumulators updated with FMA
+     */
+    __attribute__((target("avx2,fma"))) static void kernelAvx2_6x8(size_t kc, const double *a, size_t lda,
+                                                                   const double *b, size_t ldb, double *c, size_t ldc,
+                                                                   double alpha);
+
+    /**
+     * @brief 8x16 tile kernel: 16 zmm accumulators updated with FMA
+     */
+    __attribute__((target("avx512f"))) static void kernelAvx512_8x16(size_t kc, const double *a, size_t lda,
+                                                                     const double *b, size_t ldb, double *c, size_t ldc,
+                                                                     double alpha);
+#endif
+
+protected:
+    /**
+     * @brief Multiplies two matrices with the selected micro-kernel into a caller-owned output
+     * @param a First matrix
+     * @param b Second matrix
+     * @param out Receives (or accumulates) the product
+     * @param mode Overwrite out or add the product to it
+     * @param alpha Scale applied to the product
+     */
+    void compute(const Matrix &a, const Matrix &b, Matrix &out, Accumulate mode, double alpha) override;
+
+public:
+    /**
+     * @brief Construct a new Simd Multiplier object
+     * @param kernel Instruction set to use, Auto selects the best supported one
+     * @param rowBlock Rows of A per cache block (rounded up to the tile height)
+     * @param innerBlock Shared dimension per cache block
+     * @param colBlock Columns of B per cache block (rounded up to the tile width)
+     * @throw std::invalid_argument if the kernel is not supported by this CPU or a block size is zero
+     */
+    explicit SimdMultiplier(SimdKernel kernel = SimdKernel::Auto, size_t rowBlock = 96,
+                            size_t innerBlock = 256, size_t colBlock = 2048);
+
+    /**
+     * @brief Checks whether the CPU (and OS) can run a kernel
+     * @param kernel Instruction set to check
+     * @return true if the kernel can be used on this machine
+     */
+    static bool isSupported(SimdKernel kernel);
+
+    /**
+     * @brief Detects the widest kernel supported by the CPU via cpuid
+     * @return SimdKernel - AVX512, AVX2 or Scalar
+     */
+    static SimdKernel detect();
+
+    /**
+     * @brief Gets the kernel selected at construction
+     * @return SimdKernel - never Auto
+     */
+    SimdKernel getKernel() const { return kernel; }
+
+    /**
+     * @brief Accumulates C += alpha * A * B on row-major views with arbitrary row strides
+     * @param n Rows of A and C
+     * @param m Columns of B and C
+     * @param inner Columns of A, rows of B
+     * @param a Pointer to A(0,0), rows lda elements apart
+     * @param b Pointer to B(0,0), rows ldb elements apart
+     * @param c Pointer to C(0,0), rows ldc elements apart
+     * @param alpha Scale applied to the product before it is added
+     */
+    void multiplyAdd(size_t n, size_t m, size_t inner,
+                     const double *a, size_t lda, const double *b, size_t ldb,
+                     double *c, size_t ldc, double alpha = 1.0) const;
+
+    /**
+     * @brief Gets the name of the multiplication algorithm
+     * @return const char* - "SIMD" followed by the selected kernel
+     */
+    const char *getName() const override;
+};
+
+bool SimdMultiplier::isSupported(SimdKernel kernel)
+{
+    switch (kernel)
+    {
+    case SimdKernel::Auto:
+    case SimdKernel::Scalar:
+        return true;
+#ifdef MATRIX_SIMD_X86
+    // __builtin_cpu_supports reads the cpuid bits and checks that the OS saves the wide registers
+    case SimdKernel::AVX2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case SimdKernel::AVX512:
+        return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+        return false;
+    }
+}
+
+SimdKernel SimdMultiplier::detect()
+{
+    if (isSupported(SimdKernel::AVX512))
+    {
+        return SimdKernel::AVX512;
+    }
+    if (isSupported(SimdKernel::AVX2))
+    {
+        return SimdKernel::AVX2;
+    }
+    return SimdKernel::Scalar;
+}
+
+SimdMultiplier::SimdMultiplier(SimdKernel kernel, size_t rowBlock, size_t innerBlock, size_t colBlock)
+    : kernel(kernel == SimdKernel::Auto ? detect() : kernel), micro(&SimdMultiplier::kernelScalar4x4),
+      mr(4), nr(4), rowBlock(rowBlock), innerBlock(innerBlock), colBlock(colBlock)
+{
+    if (rowBlock == 0 || innerBlock == 0 || colBlock == 0)
+    {
+        throw std::invalid_argument("Block sizes must be positive");
+    }
+    if (!isSupported(this->kernel))
+    {
+        throw std::invalid_argument("Requested SIMD kernel is not supported by this CPU");
+    }
+
+#ifdef MATRIX_SIMD_X86
+    if (this->kernel == SimdKernel::AVX2)
+    {
+        micro = &SimdMultiplier::kernelAvx2_6x8;
+        mr = 6;
+        nr = 8;
+    }
+    else if (this->kernel == SimdKernel::AVX512)
+    {
+        micro = &SimdMultiplier::kernelAvx512_8x16;
+        mr = 8;
+        nr = 16;
+    }
+#endif
+
+    // cache blocks hold a whole number of register tiles
+    this->rowBlock = (rowBlock + mr - 1) / mr * mr;
+    this->colBlock = (colBlock + nr - 1) / nr * nr;
+}
+
+const char *SimdMultiplier::getName() const
+{
+    switch (kernel)
+    {
+    case SimdKernel::AVX2:
+        return "SIMD (AVX2/FMA 6x8)";
+    case SimdKernel::AVX512:
+        return "SIMD (AVX-512 8x16)";
+    default:
+        return "SIMD (scalar 4x4)";
+    }
+}
+
+void SimdMultiplier::kernelScalar4x4(size_t kc, const double *a, size_t lda,
+                                     const double *b, size_t ldb, double *c, size_t ldc, double alpha)
+{
+    double acc[4][4] = {};
+    for (size_t k = 0; k < kc; ++k)
+    {
+        const double *bRow = b + k * ldb;
+        for (size_t r = 0; r < 4; ++r)
+        {
+            const double ark = a[r * lda + k];
+            for (size_t s = 0; s < 4; ++s)
+            {
+                acc[r][s] += ark * bRow[s];
+            }
+        }
+    }
+    for (size_t r = 0; r < 4; ++r)
+    {
+        for (size_t s = 0; s < 4; ++s)
+        {
+            c[r * ldc + s] += alpha * acc[r][s];
+        }
+    }
+}
+
+void SimdMultiplier::kernelEdge(size_t kc, const double *a, size_t lda,
+                                const double *b, size_t ldb, double *c, size_t ldc,
+                                double alpha, size_t rows, size_t cols)
+{
+    for (size_t r = 0; r < rows; ++r)
+    {
+        for (size_t k = 0; k < kc; ++k)
+        {
+            const double ark = alpha * a[r * lda + k];
+            const double *bRow = b + k * ldb;
+            for (size_t s = 0; s < cols; ++s)
+            {
+                c[r * ldc + s] += ark * bRow[s];
+            }
+        }
+    }
+}
+
+#ifdef MATRIX_SIMD_X86
+void SimdMultiplier::kernelAvx2_6x8(size_t kc, const double *a, size_t lda,
+                                    const double *b, size_t ldb, double *c, size_t ldc, double alpha)
+{
+    // 6 rows x 2 vectors of 4 doubles = 12 accumulators, 2 for B, 1 broadcast
+    __m256d acc[6][2];
+    for (size_t r = 0; r < 6; ++r)
+    {
+        acc[r][0] = _mm256_setzero_pd();
+        acc[r][1] = _mm256_setzero_pd();
+    }
+
+    for (size_t k = 0; k < kc; ++k)
+    {
+        const double *bRow = b + k * ldb;
+        __m256d b0 = _mm256_loadu_pd(bRow);
+        __m256d b1 = _mm256_loadu_pd(bRow + 4);
+        for (size_t r = 0; r < 6; ++r)
+        {
+            __m256d ar = _mm256_broadcast_sd(a + r * lda + k);
+            acc[r][0] = _mm256_fmadd_pd(ar, b0, acc[r][0]);
+            acc[r][1] = _mm256_fmadd_pd(ar, b1, acc[r][1]);
+        }
+    }
+
+    const __m256d scale = _mm256_set1_pd(alpha);
+    for (size_t r = 0; r < 6; ++r)
+    {
+        double *cRow = c + r * ldc;
+        _mm256_storeu_pd(cRow, _mm256_fmadd_pd(scale, acc[r][0], _mm256_loadu_pd(cRow)));
+        _mm256_storeu_pd(cRow + 4, _mm256_fmadd_pd(scale, acc[r][1], _mm256_loadu_pd(cRow + 4)));
+    }
+}
+
+void SimdMultiplier::kernelAvx512_8x16(size_t kc, const double *a, size_t lda,
+                                       const double *b, size_t ldb, double *c, size_t ldc, double alpha)
+{
+    // 8 rows x 2 vectors of 8 doubles = 16 accumulators out of 32 registers
+    __m512d acc[8][2];
+    for (size_t r = 0; r < 8; ++r)
+    {
+        acc[r][0] = _mm512_setzero_pd();
+        acc[r][1] = _mm512_setzero_pd();
+    }
+
+    for (size_t k = 0; k < kc; ++k)
+    {
+        const double *bRow = b + k * ldb;
+        __m512d b0 = _mm512_loadu_pd(bRow);
+        __m512d b1 = _mm512_loadu_pd(bRow + 8);
+        for (size_t r = 0; r < 8; ++r)
+        {
+            __m512d ar = _mm512_set1_pd(a[r * lda + k]);
+            acc[r][0] = _mm512_fmadd_pd(ar, b0, acc[r][0]);
+            acc[r][1] = _mm512_fmadd_pd(ar, b1, acc[r][1]);
+        }
+    }
+
+    const __m512d scale = _mm512_set1_pd(alpha);
+    for (size_t r = 0; r < 8; ++r)
+    {
+        double *cRow = c + r * ldc;
+        _mm512_storeu_pd(cRow, _mm512_fmadd_pd(scale, acc[r][0], _mm512_loadu_pd(cRow)));
+        _mm512_storeu_pd(cRow + 8, _mm512_fmadd_pd(scale, acc[r][1], _mm512_loadu_pd(cRow + 8)));
+    }
+}
+#endif
+
+void SimdMultiplier::multiplyAdd(size_t n, size_t m, size_t inner,
+                                 const double *a, size_t lda, const double *b, size_t ldb,
+                                 double *c, size_t ldc, double alpha) const
+{
+    for (size_t jj = 0; jj < m; jj += colBlock)
+    {
+        const size_t jEnd = min(jj + colBlock, m);
+        for (size_t kk = 0; kk < inner; kk += innerBlock)
+        {
+            const size_t kc = min(innerBlock, inner - kk);
+            for (size_t ii = 0; ii < n; ii += rowBlock)
+            {
+                const size_t iEnd = min(ii + rowBlock, n);
+
+                for (size_t j = jj; j < jEnd; j += nr)
+                {
+                    const size_t cols = min(nr, jEnd - j);
+                    for (size_t i = ii; i < iEnd; i += mr)
+                    {
+                        const size_t rows = min(mr, iEnd - i);
+                        const double *aTile = a + i * lda + kk;
+                        const double *bTile = b + kk * ldb + j;
+                        double *cTile = c + i * ldc + j;
+
+                        if (rows == mr && cols == nr)
+                        {
+                            micro(kc, aTile, lda, bTile, ldb, cTile, ldc, alpha);
+                        }
+                        else
+                        {
+                            kernelEdge(kc, aTile, lda, bTile, ldb, cTile, ldc, alpha, rows, cols);
+                        }
+                    }
+                }
+                finishTile();
+            }
+        }
+    }
+}
+
+void SimdMultiplier::compute(const Matrix &a, const Matrix &b, Matrix &out, Accumulate mode,
+                             double alpha)
+{
+    prepareOutput(a, b, out, mode);
+
+    // every cache block is one tile
+    startTiles(((a.getRows() + rowBlock - 1) / rowBlock) * ((a.getCols() + innerBlock - 1) / innerBlock) *
+               ((b.getCols() + colBlock - 1) / colBlock));
+    multiplyAdd(a.getRows(), b.getCols(), a.getCols(),
+                a.data(), a.getStride(), b.data(), b.getStride(),
+                out.data(), out.getStride(), alpha);
+}
@@ -0,0 +1,289 @@
+#pragma once
+#include "Matrix.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Compression direction of a sparse matrix
+ */
+enum class SparseFormat
+{
+    CSR, // compressed sparse rows: offsets per row, column indices
+    CSC  // compressed sparse columns: offsets per column, row indices
+};
+
+/**
+ * @brief Sparse matrix in compressed row (CSR) or compressed column (CSC) form
+ *
+ * Only the non-zero elements are stored. For CSR, the non-zeros of row i are
+ * values[offsets[i] .. offsets[i+1]) with their column numbers in the same
+ * range of indices; CSC is the same with rows and columns swapped. Indices
+ * are sorted and unique inside every row (column). Memory is
+ * O(nonZeros + rows) for CSR and O(nonZeros + cols) for CSC.
+ *
+ * @tparam T Element type; instantiated for float and double.
+ * SparseMatrix is the double version.
+ */
+template <typename T>
+class BasicSparseMatrix
+{
+private:
+    size_t rows;            // Number of rows in the matrix
+    size_t cols;            // Number of columns in the matrix
+    SparseFormat format;    // Whether rows or columns are compressed
+    vector<size_t> offsets; // Start of every compressed row (column) in indices/values, plus the end
+    vector<size_t> indices; // Column (row) index of every non-zero
+    vector<T> values;       // Value of every non-zero
+
+    /**
+     * @brief Gets the number of compressed rows (CSR) or columns (CSC)
+     */
+    size_t majorSize() const { return format == SparseFormat::CSR ? rows : cols; }
+
+    /**
+     * @brief Gets the length of a compressed row (CSR) or column (CSC)
+     */
+    size_t minorSize() const { return format == SparseFormat::CSR ? cols : rows; }
+
+public:
+    /**
+     * @brief Construct a new Sparse Matrix object with no non-zeros
+     * @param rows Number of rows in the matrix
+     * @param cols Number of columns in the matrix
+     * @param format Compression direction
+     */
+    BasicSparseMatrix(size_t rows, size_t cols, SparseFormat format = SparseFormat::CSR);
+
+    /**
+     * @brief Construct a new Sparse Matrix object from compressed arrays
+     *
+     * @param rows Number of rows in the matrix
+     * @param cols Number of columns in the matrix
+     * @param offsets Start of every compressed row (column), plus the total count
+     * @param indices Column (row) index of every non-zero, sorted within a row (column)
+     * @param values Value of every non-zero
+     * @param format Compression direction of the arrays
+     * @throw std::invalid_argument if the arrays do not describe a valid matrix
+     */
+    BasicSparseMatrix(size_t rows, size_t cols, vector<size_t> offsets, vector<size_t> indices,
+                      vector<T> values, SparseFormat format = SparseFormat::CSR);
+
+    /**
+     * @brief Compresses a dense matrix
+     * @param dense Matrix to compress
+     * @param format Compression direction of the result
+     * @param threshold Elements with an absolute value not above it are dropped
+     * @return BasicSparseMatrix - the non-zeros of dense
+     */
+    static BasicSparseMatrix fromDense(const BasicMatrix<T> &dense, SparseFormat format = SparseFormat::CSR,
+                                       T threshold = T(0));
+
+    /**
+     * @brief Expands the matrix into a dense one
+     * @return BasicMatrix<T> - the same matrix with the zeros stored
+     */
+    BasicMatrix<T> toDense() const;
+
+    /**
+     * @brief Converts between CSR and CSC in O(nonZeros + rows + cols)
+     * @param target Compression direction of the result
+     * @return BasicSparseMatrix - the same matrix in the target format
+     */
+    BasicSparseMatrix convert(SparseFormat target) const;
+
+    /**
+     * @brief Transposes the matrix without moving any element
+     *
+     * The CSR arrays of a matrix are the CSC arrays of its transpose, so only
+     * the dimensions and the format are swapped.
+     *
+     * @return BasicSparseMatrix - transposed matrix in the other format
+     */
+    BasicSparseMatrix transpose() const;
+
+    /**
+     * @brief Gets the number of rows in the matrix
+     * @return size_t - number of rows
+     */
+    size_t getRows() const { return rows; }
+
+    /**
+     * @brief Gets the number of columns in the matrix
+     * @return size_t - number of columns
+     */
+    size_t getCols() const { return cols; }
+
+    /**
+     * @brief Gets the compression direction
+     * @return SparseFormat - CSR or CSC
+     */
+    SparseFormat getFormat() const { return format; }
+
+    /**
+     * @brief Gets the number of stored elements
+     * @return size_t - number of non-zeros
+     */
+    size_t nonZeros() const { return values.size(); }
+
+    /**
+     * @brief Gets the compressed arrays
+     * @return const vector& - offsets (rows or columns + 1 entries), indices and values (nonZeros() entries)
+     */
+    const vector<size_t> &getOffsets() const { return offsets; }
+    const vector<size_t> &getIndices() const { return indices; }
+    const vector<T> &getValues() const { return values; }
+
+    /**
+     * @brief Looks up an element with a binary search in its row (column)
+     * @param i Row index (0-based)
+     * @param j Column index (0-based)
+     * @return T - the element, zero if it is not stored
+     */
+    T at(size_t i, size_t j) const;
+};
+
+/**
+ * @brief Sparse matrix of doubles
+ */
+using SparseMatrix = BasicSparseMatrix<double>;
+
+template <typename T>
+BasicSparseMatrix<T>::BasicSparseMatrix(size_t rows, size_t cols, SparseFormat format)
+    : rows(rows), cols(cols), format(format), offsets(majorSize() + 1, 0) {}
+
+template <typename T>
+BasicSparseMatrix<T>::BasicSparseMatrix(size_t rows, size_t cols, vector<size_t> offsets, vector<size_t> indices,
+                                        vector<T> values, SparseFormat format)
+    : rows(rows), cols(cols), format(format), offsets(std::move(offsets)),
+      indices(std::move(indices)), values(std::move(values))
+{
+    if (this->offsets.size() != majorSize() + 1 || this->offsets.front() != 0 ||
+        this->offsets.back() != this->values.size() || this->indices.size() != this->values.size())
+    {
+        throw std::invalid_argument("Sparse matrix arrays have inconsistent sizes");
+    }
+    for (size_t p = 0; p < majorSize(); ++p)
+    {
+        if (this->offsets[p] > this->offsets[p + 1])
+        {
+            throw std::invalid_argument("Sparse matrix offsets must not decrease");
+        }
+        for (size_t q = this->offsets[p]; q < this->offsets[p + 1]; ++q)
+        {
+            if (this->indices[q] >= minorSize() ||
+                (q > this->offsets[p] && this->indices[q] <= this->indices[q - 1]))
+            {
+                throw std::invalid_argument("Sparse matrix indices must be in range, sorted and unique");
+            }
+        }
+    }
+}
+
+template <typename T>
+BasicSparseMatrix<T> BasicSparseMatrix<T>::fromDense(const BasicMatrix<T> &dense, SparseFormat format, T threshold)
+{
+    BasicSparseMatrix result(dense.getRows(), dense.getCols(), format);
+    const size_t major = result.majorSize();
+    const size_t minor = result.minorSize();
+
+    for (size_t p = 0; p < major; ++p)
+    {
+        for (size_t q = 0; q < minor; ++q)
+        {
+            const T value = format == SparseFormat::CSR ? dense.at(p, q) : dense.at(q, p);
+            if (abs(value) > threshold)
+            {
+                result.indices.push_back(q);
+                result.values.push_back(value);
+            }
+        }
+        result.offsets[p + 1] = result.values.size();
+    }
+    return result;
+}
+
+template <typename T>
+BasicMatrix<T> BasicSparseMatrix<T>::toDense() const
+{
+    BasicMatrix<T> dense(rows, cols);
+    for (size_t p = 0; p < majorSize(); ++p)
+    {
+        for (size_t q = offsets[p]; q < offsets[p + 1]; ++q)
+        {
+            if (format == SparseFormat::CSR)
+            {
+                dense.at(p, indices[q]) = values[q];
+            }
+            else
+            {
+                dense.at(indices[q], p) = values[q];
+            }
+        }
+    }
+    return dense;
+}
+
+template <typename T>
+BasicSparseMatrix<T> BasicSparseMatrix<T>::convert(SparseFormat target) const
+{
+    if (target == format)
+    {
+        return *this;
+    }
+
+    BasicSparseMatrix result(rows, cols, target);
+    const size_t minor = minorSize();
+
+    // counting sort by the minor index; walking the major index in order keeps the new indices sorted
+    vector<size_t> &counts = result.offsets;
+    for (size_t idx : indices)
+    {
+        ++counts[idx + 1];
+    }
+    for (size_t q = 0; q < minor; ++q)
+    {
+        counts[q + 1] += counts[q];
+    }
+
+    result.indices.resize(nonZeros());
+    result.values.resize(nonZeros());
+    vector<size_t> next(counts.begin(), counts.end() - 1);
+    for (size_t p = 0; p < majorSize(); ++p)
+    {
+        for (size_t q = offsets[p]; q < offsets[p + 1]; ++q)
+        {
+            const size_t dst = next[indices[q]]++;
+            result.indices[dst] = p;
+            result.values[dst] = values[q];
+        }
+    }
+    return result;
+}
+
+template <typename T>
+BasicSparseMatrix<T> BasicSparseMatrix<T>::transpose() const
+{
+    BasicSparseMatrix result(*this);
+    swap(result.rows, result.cols);
+    result.format = format == SparseFormat::CSR ? SparseFormat::CSC : SparseFormat::CSR;
+    return result;
+}
+
+template <typename T>
+T BasicSparseMatrix<T>::at(size_t i, size_t j) const
+{
+    const size_t p = format == SparseFormat::CSR ? i : j;
+    const size_t q = format == SparseFormat::CSR ? j : i;
+
+    auto first = indices.begin() + offsets[p];
+    auto last = indices.begin() + offsets[p + 1];
+    auto it = lower_bound(first, last, q);
+    return it != last && *it == q ? values[it - indices.begin()] : T(0);
+}
+
+template class BasicSparseMatrix<float>;
+template class BasicSparseMatrix<double>;
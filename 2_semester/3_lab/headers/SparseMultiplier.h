@@ -0,0 +1,293 @@
+// sparse multiplier interface
+// strategy pattern used, as for the dense multipliers
+
+#pragma once
+#include "SparseMatrix.h"
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief Abstract base class for sparse matrix multiplication algorithms
+ *
+ * Three products are offered, each with a cost proportional to the number
+ * of non-zeros touched rather than to the full dimensions:
+ *  - SpMV: sparse matrix times dense vector,
+ *  - SpMM: sparse matrix times dense matrix,
+ *  - SpGEMM: sparse matrix times sparse matrix (Gustavson's row-by-row algorithm).
+ * The row-range kernels shared by all strategies live here; the strategies
+ * decide how the rows are scheduled. CSC operands of SpMM and SpGEMM are
+ * converted to CSR first (O(nonZeros)); SpMV works on both formats directly.
+ *
+ * @tparam T Element type of the matrices
+ */
+template <typename T>
+class BasicSparseMultiplier
+{
+protected:
+    /**
+     * @brief Output of SpGEMM for a range of rows, assembled into the result afterwards
+     */
+    struct RowsProduct
+    {
+        vector<size_t> rowCounts; // non-zeros of every row in the range
+        vector<size_t> indices;   // column indices, row after row
+        vector<T> values;         // values, row after row
+    };
+
+    /**
+     * @brief Validates the dimensions of a product
+     * @param aRows Rows of the left operand
+     * @param aCols Columns of the left operand
+     * @param bRows Rows of the right operand
+     * @param bCols Columns of the right operand
+     * @throw std::invalid_argument if an operand is empty or the dimensions do not match
+     */
+    static void validateDimensions(size_t aRows, size_t aCols, size_t bRows, size_t bCols);
+
+    /**
+     * @brief Gets m in CSR form, converting it into storage only if it is CSC
+     * @param m Operand
+     * @param storage Holder of the converted copy
+     * @return const BasicSparseMatrix<T>& - m itself or storage
+     */
+    static const BasicSparseMatrix<T> &asCsr(const BasicSparseMatrix<T> &m, BasicSparseMatrix<T> &storage);
+
+    /**
+     * @brief y[i] = row i of CSR a times x, for rows [begin, end)
+     */
+    static void spmvRows(const BasicSparseMatrix<T> &a, const T *x, T *y, size_t begin, size_t end);
+
+    /**
+     * @brief y += columns [begin, end) of CSC a times the matching entries of x
+     */
+    static void spmvColumns(const BasicSparseMatrix<T> &a, const T *x, T *y, size_t begin, size_t end);
+
+    /**
+     * @brief Rows [begin, end) of C = CSR a * dense b, C must be zero there
+     */
+    static void spmmRows(const BasicSparseMatrix<T> &a, const BasicMatrix<T> &b, BasicMatrix<T> &c,
+                         size_t begin, size_t end);
+
+    /**
+     * @brief Rows [begin, end) of CSR a * CSR b with a dense accumulator of b.getCols() entries
+     */
+    static RowsProduct spgemmRows(const BasicSparseMatrix<T> &a, const BasicSparseMatrix<T> &b,
+                                  size_t begin, size_t end);
+
+    /**
+     * @brief Concatenates the products of consecutive row ranges into a CSR matrix
+     */
+    static BasicSparseMatrix<T> assemble(size_t rows, size_t cols, vector<RowsProduct> &parts);
+
+public:
+    /**
+     * @brief Multiplies a sparse matrix by a dense vector (SpMV)
+     * @param a Sparse matrix, CSR or CSC
+     * @param x Vector of a.getCols() elements
+     * @return vector<T> - a * x, a.getRows() elements
+     * @throw std::invalid_argument if the length of x does not match
+     */
+    virtual vector<T> multiply(const BasicSparseMatrix<T> &a, const vector<T> &x) = 0;
+
+    /**
+     * @brief Multiplies a sparse matrix by a dense matrix (SpMM)
+     * @param a Sparse matrix
+     * @param b Dense matrix
+     * @return BasicMatrix<T> - dense result
+     * @throw std::invalid_argument if the dimensions do not match
+     */
+    virtual BasicMatrix<T> multiply(const BasicSparseMatrix<T> &a, const BasicMatrix<T> &b) = 0;
+
+    /**
+     * @brief Multiplies two sparse matrices (SpGEMM)
+     * @param a First sparse matrix
+     * @param b Second sparse matrix
+     * @return BasicSparseMatrix<T> - sparse result in CSR
+     * @throw std::invalid_argument if the dimensions do not match
+     */
+    virtual BasicSparseMatrix<T> multiply(const BasicSparseMatrix<T> &a, const BasicSparseMatrix<T> &b) = 0;
+
+    /**
+     * @brief Gets the name of the multiplication algorithm
+     * @return const char* - string identifier for the algorithm
+     */
+    virtual const char *getName() const = 0;
+
+    /**
+     * @brief Virtual destructor
+     */
+    virtual ~BasicSparseMultiplier() = default;
+};
+
+/**
+ * @brief Sparse multiplier of double matrices
+ */
+using SparseMultiplier = BasicSparseMultiplier<double>;
+
+template <typename T>
+void BasicSparseMultiplier<T>::validateDimensions(size_t aRows, size_t aCols, size_t bRows, size_t bCols)
+{
+    if (aRows == 0 || aCols == 0 || bRows == 0 || bCols == 0)
+    {
+        throw std::invalid_argument("Cannot multiply empty matrices");
+    }
+    if (aCols != bRows)
+    {
+        throw std::invalid_argument("Matrix dimensions are not compatible for multiplication");
+    }
+}
+
+template <typename T>
+const BasicSparseMatrix<T> &BasicSparseMultiplier<T>::asCsr(const BasicSparseMatrix<T> &m,
+                                                            BasicSparseMatrix<T> &storage)
+{
+    if (m.getFormat() == SparseFormat::CSR)
+    {
+        return m;
+    }
+    storage = m.convert(SparseFormat::CSR);
+    return storage;
+}
+
+template <typename T>
+void BasicSparseMultiplier<T>::spmvRows(const BasicSparseMatrix<T> &a, const T *x, T *y, size_t begin, size_t end)
+{
+    const vector<size_t> &offsets = a.getOffsets();
+    const vector<size_t> &indices = a.getIndices();
+    const vector<T> &values = a.getValues();
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        T sum = T(0);
+        for (size_t q = offsets[i]; q < offsets[i + 1]; ++q)
+        {
+            sum += values[q] * x[indices[q]];
+        }
+        y[i] = sum;
+    }
+}
+
+template <typename T>
+void BasicSparseMultiplier<T>::spmvColumns(const BasicSparseMatrix<T> &a, const T *x, T *y, size_t begin, size_t end)
+{
+    const vector<size_t> &offsets = a.getOffsets();
+    const vector<size_t> &indices = a.getIndices();
+    const vector<T> &values = a.getValues();
+
+    for (size_t j = begin; j < end; ++j)
+    {
+        const T xj = x[j];
+        for (size_t q = offsets[j]; q < offsets[j + 1]; ++q)
+        {
+            y[indices[q]] += values[q] * xj;
+        }
+    }
+}
+
+template <typename T>
+void BasicSparseMultiplier<T>::spmmRows(const BasicSparseMatrix<T> &a, const BasicMatrix<T> &b, BasicMatrix<T> &c,
+                                        size_t begin, size_t end)
+{
+    const vector<size_t> &offsets = a.getOffsets();
+    const vector<size_t> &indices = a.getIndices();
+    const vector<T> &values = a.getValues();
+    const size_t m = b.getCols();
+
+    // row i of C is a combination of the rows of B selected by the non-zeros of row i of A
+    for (size_t i = begin; i < end; ++i)
+    {
+        T *cRow = c.rowPtr(i);
+        for (size_t q = offsets[i]; q < offsets[i + 1]; ++q)
+        {
+            const T aik = values[q];
+            const T *bRow = b.rowPtr(indices[q]);
+            for (size_t j = 0; j < m; ++j)
+            {
+                cRow[j] += aik * bRow[j];
+            }
+        }
+    }
+}
+
+template <typename T>
+typename BasicSparseMultiplier<T>::RowsProduct
+BasicSparseMultiplier<T>::spgemmRows(const BasicSparseMatrix<T> &a, const BasicSparseMatrix<T> &b,
+                                     size_t begin, size_t end)
+{
+    const vector<size_t> &aOffsets = a.getOffsets();
+    const vector<size_t> &aIndices = a.getIndices();
+    const vector<T> &aValues = a.getValues();
+    const vector<size_t> &bOffsets = b.getOffsets();
+    const vector<size_t> &bIndices = b.getIndices();
+    const vector<T> &bValues = b.getValues();
+
+    RowsProduct part;
+    part.rowCounts.reserve(end - begin);
+
+    // dense accumulator for one row of C; only the touched columns are visited and reset
+    vector<T> accumulator(b.getCols(), T(0));
+    vector<bool> occupied(b.getCols(), false);
+    vector<size_t> touched;
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        for (size_t q = aOffsets[i]; q < aOffsets[i + 1]; ++q)
+        {
+            const size_t k = aIndices[q];
+            const T aik = aValues[q];
+            for (size_t r = bOffsets[k]; r < bOffsets[k + 1]; ++r)
+            {
+                const size_t j = bIndices[r];
+                if (!occupied[j])
+                {
+                    occupied[j] = true;
+                    touched.push_back(j);
+                }
+                accumulator[j] += aik * bValues[r];
+            }
+        }
+
+        sort(touched.begin(), touched.end());
+        for (size_t j : touched)
+        {
+            part.indices.push_back(j);
+            part.values.push_back(accumulator[j]);
+            accumulator[j] = T(0);
+            occupied[j] = false;
+        }
+        part.rowCounts.push_back(touched.size());
+        touched.clear();
+    }
+    return part;
+}
+
+template <typename T>
+BasicSparseMatrix<T> BasicSparseMultiplier<T>::assemble(size_t rows, size_t cols, vector<RowsProduct> &parts)
+{
+    vector<size_t> offsets(1, 0);
+    offsets.reserve(rows + 1);
+    size_t total = 0;
+    for (const RowsProduct &part : parts)
+    {
+        total += part.values.size();
+    }
+
+    vector<size_t> indices;
+    vector<T> values;
+    indices.reserve(total);
+    values.reserve(total);
+    for (RowsProduct &part : parts)
+    {
+        for (size_t count : part.rowCounts)
+        {
+            offsets.push_back(offsets.back() + count);
+        }
+        indices.insert(indices.end(), part.indices.begin(), part.indices.end());
+        values.insert(values.end(), part.values.begin(), part.values.end());
+        part = RowsProduct(); // release the part as soon as it is copied
+    }
+    return BasicSparseMatrix<T>(rows, cols, std::move(offsets), std::move(indices), std::move(values));
+}
+
+template class BasicSparseMultiplier<float>;
+template class BasicSparseMultiplier<double>;
@@ -0,0 +1,287 @@
+#pragma once
+#include "MatrixMultiplier.h"
+#include "SimdMultiplier.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+/**
+ * @brief Strassen-Winograd recursive matrix multiplication
+ *
+ * Every level splits A, B and C into 2x2 quadrants and computes the product
+ * with 7 quadrant multiplications and 15 additions instead of 8 multiplications.
+ * The recursion stops once a dimension is not larger than the cutoff, the
+ * remaining products are done by the SIMD micro-kernel.
+ *
+ * Sizes that cannot be halved down to the cutoff are zero-padded once at the
+ * top, to the nearest multiple of 2^depth. The quadrant products are scheduled
+ * so that each level needs only two temporaries (X and Y); all of them are
+ * carved from one workspace, so the extra memory stays below two thirds of
+ * one padded matrix regardless of the depth. The workspace and the padded
+ * copies are kept by the multiplier and only grow, so repeated products of
+ * one size do not allocate.
+ */
+class StrassenMultiplier : public MatrixMultiplier
+{
+private:
+    size_t cutoff;             // stop recursing when a dimension is <= cutoff
+    SimdMultiplier base;       // kernel for the leaves of the recursion
+    vector<double> workspace;  // temporaries of all levels, reused across calls
+    Matrix paddedA;            // zero-padded copies for sizes not divisible by 2^depth
+    Matrix paddedB;
+    Matrix product;            // product before it is cropped or added to the output
+
+    /**
+     * @brief Z = X + sign * Y on row-major views
+     */
+    static void addViews(size_t rows, size_t cols, const double *x, size_t ldx,
+                         const double *y, size_t ldy, double *z, size_t ldz, double sign);
+
+    /**
+     * @brief Copies src into the top-left corner of dst, shaped rows x cols, and zeroes the rest
+     */
+    static void padInto(const Matrix &src, Matrix &dst, size_t rows, size_t cols);
+
+    /**
+     * @brief Computes how many times the dimensions are halved before the cutoff
+     * @return size_t - number of levels of recursion
+     */
+    size_t plan(size_t n, size_t inner, size_t m) const;
+
+    /**
+     * @brief Workspace (in elements) needed by recurse() for the given sizes
+     */
+    static size_t workspaceSize(size_t n, size_t inner, size_t m, size_t depth);
+
+    /**
+     * @brief C = A * B, dimensions divisible by 2^depth
+     * @param work Scratch memory of at least workspaceSize() elements
+     */
+    void recurse(size_t n, size_t inner, size_t m,
+                 const double *a, size_t lda, const double *b, size_t ldb,
+                 double *c, size_t ldc, double *work, size_t depth) const;
+
+protected:
+    /**
+     * @brief Multiplies two matrices with Strassen-Winograd recursion into a caller-owned output
+     * @param a First matrix
+     * @param b Second matrix
+     * @param out Receives (or accumulates) the product
+     * @param mode Overwrite out or add the product to it
+     * @param alpha Scale applied to the product
+     */
+    void compute(const Matrix &a, const Matrix &b, Matrix &out, Accumulate mode, double alpha) override;
+
+public:
+    /**
+     * @brief Construct a new Strassen Multiplier object
+     * @param cutoff Size at or below which the base kernel is used
+     * @throw std::invalid_argument if cutoff is zero
+     */
+    explicit StrassenMultiplier(size_t cutoff = 256);
+
+    /**
+     * @brief Gets the name of the multiplication algorithm
+     * @return const char* - "Strassen-Winograd" as the algorithm identifier
+     */
+    const char *getName() const override { return "Strassen-Winograd"; }
+};
+
+StrassenMultiplier::StrassenMultiplier(size_t cutoff)
+    : cutoff(cutoff), paddedA(0, 0), paddedB(0, 0), product(0, 0)
+{
+    if (cutoff == 0)
+    {
+        throw std::invalid_argument("Cutoff must be positive");
+    }
+}
+
+void StrassenMultiplier::addViews(size_t rows, size_t cols, const double *x, size_t ldx,
+                                  const double *y, size_t ldy, double *z, size_t ldz, double sign)
+{
+    for (size_t i = 0; i < rows; ++i)
+    {
+        const double *xRow = x + i * ldx;
+        const double *yRow = y + i * ldy;
+        double *zRow = z + i * ldz;
+        for (size_t j = 0; j < cols; ++j)
+        {
+            zRow[j] = xRow[j] + sign * yRow[j];
+        }
+    }
+}
+
+void StrassenMultiplier::padInto(const Matrix &src, Matrix &dst, size_t rows, size_t cols)
+{
+    dst.resize(rows, cols);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        double *row = dst.rowPtr(i);
+        size_t filled = 0;
+        if (i < src.getRows())
+        {
+            filled = src.getCols();
+            copy_n(src.rowPtr(i), filled, row);
+        }
+        fill(row + filled, row + cols, 0.0);
+    }
+}
+
+size_t StrassenMultiplier::plan(size_t n, size_t inner, size_t m) const
+{
+    size_t depth = 0;
+    size_t smallest = min({n, inner, m});
+    while (smallest > cutoff)
+    {
+        smallest = (smallest + 1) / 2;
+        ++depth;
+    }
+    return depth;
+}
+
+size_t StrassenMultiplier::workspaceSize(size_t n, size_t inner, size_t m, size_t depth)
+{
+    size_t total = 0;
+    for (size_t level = 0; level < depth; ++level)
+    {
+        n /= 2;
+        inner /= 2;
+        m /= 2;
+        total += n * max(inner, m) + inner * m; // X holds S_i or P1, Y holds T_i
+    }
+    return total;
+}
+
+void StrassenMultiplier::recurse(size_t n, size_t inner, size_t m,
+                                 const double *a, size_t lda, const double *b, size_t ldb,
+                                 double *c, size_t ldc, double *work, size_t depth) const
+{
+    if (depth == 0)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            memset(c + i * ldc, 0, m * sizeof(double));
+        }
+        base.multiplyAdd(n, m, inner, a, lda, b, ldb, c, ldc);
+        finishTile();
+        return;
+    }
+
+    const size_t n2 = n / 2, k2 = inner / 2, m2 = m / 2;
+
+    const double *a11 = a, *a12 = a + k2, *a21 = a + n2 * lda, *a22 = a21 + k2;
+    const double *b11 = b, *b12 = b + m2, *b21 = b + k2 * ldb, *b22 = b21 + m2;
+    double *c11 = c, *c12 = c + m2, *c21 = c + n2 * ldc, *c22 = c21 + m2;
+
+    // two temporaries for this level, the deeper levels use the rest of the workspace
+    const size_t ldx = max(k2, m2);
+    const size_t ldy = m2;
+    double *x = work;
+    double *y = x + n2 * ldx;
+    double *next = y + k2 * ldy;
+    const size_t d = depth - 1;
+
+    addViews(n2, k2, a11, lda, a21, lda, x, ldx, -1.0);           // S3 = A11 - A21
+    addViews(k2, m2, b22, ldb, b12, ldb, y, ldy, -1.0);           // T3 = B22 - B12
+    recurse(n2, k2, m2, x, ldx, y, ldy, c21, ldc, next, d);       // P7 = S3 * T3 -> C21
+    addViews(n2, k2, a21, lda, a22, lda, x, ldx, 1.0);            // S1 = A21 + A22
+    addViews(k2, m2, b12, ldb, b11, ldb, y, ldy, -1.0);           // T1 = B12 - B11
+    recurse(n2, k2, m2, x, ldx, y, ldy, c22, ldc, next, d);       // P5 = S1 * T1 -> C22
+    addViews(n2, k2, x, ldx, a11, lda, x, ldx, -1.0);             // S2 = S1 - A11
+    addViews(k2, m2, b22, ldb, y, ldy, y, ldy, -1.0);             // T2 = B22 - T1
+    recurse(n2, k2, m2, x, ldx, y, ldy, c12, ldc, next, d);       // P6 = S2 * T2 -> C12
+    addViews(n2, k2, a12, lda, x, ldx, x, ldx, -1.0);             // S4 = A12 - S2
+    recurse(n2, k2, m2, x, ldx, b22, ldb, c11, ldc, next, d);     // P3 = S4 * B22 -> C11
+    recurse(n2, k2, m2, a11, lda, b11, ldb, x, ldx, next, d);     // P1 = A11 * B11 -> X
+    addViews(n2, m2, x, ldx, c12, ldc, c12, ldc, 1.0);            // U2 = P1 + P6 -> C12
+    addViews(n2, m2, c12, ldc, c21, ldc, c21, ldc, 1.0);          // U3 = U2 + P7 -> C21
+    addViews(n2, m2, c12, ldc, c22, ldc, c12, ldc, 1.0);          // U4 = U2 + P5 -> C12
+    addViews(n2, m2, c21, ldc, c22, ldc, c22, ldc, 1.0);          // U7 = U3 + P5 -> C22
+    addViews(n2, m2, c12, ldc, c11, ldc, c12, ldc, 1.0);          // U5 = U4 + P3 -> C12
+    addViews(k2, m2, y, ldy, b21, ldb, y, ldy, -1.0);             // T4 = T2 - B21
+    recurse(n2, k2, m2, a22, lda, y, ldy, c11, ldc, next, d);     // P4 = A22 * T4 -> C11
+    addViews(n2, m2, c21, ldc, c11, ldc, c21, ldc, -1.0);         // U6 = U3 - P4 -> C21
+    recurse(n2, k2, m2, a12, lda, b21, ldb, c11, ldc, next, d);   // P2 = A12 * B21 -> C11
+    addViews(n2, m2, x, ldx, c11, ldc, c11, ldc, 1.0);            // U1 = P1 + P2 -> C11
+}
+
+void StrassenMultiplier::compute(const Matrix &a, const Matrix &b, Matrix &out, Accumulate mode,
+                                 double alpha)
+{
+    validateOutput(a, b, out, mode);
+
+    const size_t n = a.getRows();
+    const size_t inner = a.getCols();
+    const size_t m = b.getCols();
+
+    const size_t depth = plan(n, inner, m);
+    const size_t unit = size_t(1) << depth;
+    const size_t pn = (n + unit - 1) / unit * unit;
+    const size_t pk = (inner + unit - 1) / unit * unit;
+    const size_t pm = (m + unit - 1) / unit * unit;
+
+    // every leaf of the recursion is one tile, each level has seven products
+    size_t leaves = 1;
+    for (size_t level = 0; level < depth; ++level)
+    {
+        leaves *= 7;
+    }
+    startTiles(leaves);
+
+    const size_t needed = workspaceSize(pn, pk, pm, depth);
+    if (workspace.size() < needed)
+    {
+        workspace.resize(needed);
+    }
+
+    const bool exact = pn == n && pk == inner && pm == m;
+    if (exact && mode == Accumulate::Overwrite)
+    {
+        // the recursion writes every element of C, so the output needs no zeroing
+        out.resize(n, m);
+        recurse(n, inner, m, a.data(), a.getStride(), b.data(), b.getStride(),
+                out.data(), out.getStride(), workspace.data(), depth);
+        if (alpha != 1.0)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                double *row = out.rowPtr(i);
+                for (size_t j = 0; j < m; ++j)
+                {
+                    row[j] *= alpha;
+                }
+            }
+        }
+        return;
+    }
+
+    // zero-pad to a multiple of 2^depth, the padding does not change the product
+    const Matrix *pa = &a;
+    const Matrix *pb = &b;
+    if (!exact)
+    {
+        // the copies may be left over from an earlier call, so the padding is cleared too
+        padInto(a, paddedA, pn, pk);
+        padInto(b, paddedB, pk, pm);
+        pa = &paddedA;
+        pb = &paddedB;
+    }
+
+    product.resize(pn, pm);
+    recurse(pn, pk, pm, pa->data(), pa->getStride(), pb->data(), pb->getStride(),
+            product.data(), product.getStride(), workspace.data(), depth);
+
+    if (mode == Accumulate::Overwrite)
+    {
+        out.resize(n, m);
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        const double *src = product.rowPtr(i);
+        double *dst = out.rowPtr(i);
+        for (size_t j = 0; j < m; ++j)
+        {
+            dst[j] = mode == Accumulate::Add ? dst[j] + alpha * src[j] : alpha * src[j];
+        }
+    }
+}
@@ -0,0 +1,432 @@
+#pragma once
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace std;
+
+/**
+ * @brief Placement of pinned pool workers on the cores of the machine
+ */
+enum class PinningPolicy
+{
+    None,    // workers float, the OS scheduler places them
+    Compact, // fill the cores of one NUMA node before moving to the next
+    Scatter  // round-robin over the NUMA nodes, spreading memory bandwidth
+};
+
+/**
+ * @brief Fixed set of long-lived worker threads fed from a task queue
+ *
+ * Workers are started once in the constructor and reused for every submitted
+ * task, so callers that run many short parallel jobs do not pay for thread
+ * creation each time. A single pool can be shared by several multipliers
+ * (see ThreadPool::shared()) to keep the total number of threads equal to
+ * the number of cores. Tasks must not block waiting for other tasks of the
+ * same pool, otherwise all workers may end up waiting.
+ *
+ * On NUMA machines the workers can be pinned to cores (see PinningPolicy)
+ * and tasks can be sent to one particular worker with submitTo(). Memory
+ * is placed on the node of the thread that first writes it, so a task that
+ * always runs on the same pinned worker keeps its data local.
+ */
+class ThreadPool
+{
+private:
+    vector<thread> workers;                 // worker threads
+    queue<function<void()>> tasks;          // pending tasks for any worker, FIFO
+    vector<queue<function<void()>>> local;  // pending tasks for one worker each, FIFO
+    mutex queueMutex;                       // guards tasks, local and stopping
+    condition_variable taskAvailable;       // signalled on new task or shutdown
+    bool stopping;                          // set by the destructor
+    PinningPolicy pinning;                  // how the workers are placed
+    vector<int> cpus;                       // cpu of every worker, empty if not pinned
+
+    /**
+     * @brief Loop run by every worker: take a task, run it, repeat
+     * @param id Index of the worker; its own tasks are taken before shared ones
+     */
+    void workerLoop(size_t id);
+
+    /**
+     * @brief Pins the calling thread to a cpu, does nothing where unsupported
+     * @param cpu Logical cpu number
+     */
+    static void pinCurrentThread(int cpu);
+
+    /**
+     * @brief Reads the cpus of every NUMA node the process may run on
+     * @return vector<vector<int>> - one list per node, a single node if the topology is unknown
+     */
+    static vector<vector<int>> numaNodes();
+
+    /**
+     * @brief Queues a task on the shared queue or on one worker's queue
+     */
+    template <typename F>
+    auto enqueue(F &&task, queue<function<void()>> *target) -> future<invoke_result_t<decay_t<F>>>;
+
+public:
+    /**
+     * @brief Gets the default number of workers: one per hardware thread
+     * @return size_t - at least 1, also when the number of cores is unknown
+     */
+    static size_t defaultSize() { return max<size_t>(1, thread::hardware_concurrency()); }
+
+    /**
+     * @brief Construct a new Thread Pool object and start the workers
+     * @param numThreads Number of worker threads
+     * @param pinning Placement of the workers on the cores
+     * @throw std::invalid_argument if numThreads is zero
+     */
+    explicit ThreadPool(size_t numThreads = defaultSize(),
+                        PinningPolicy pinning = PinningPolicy::None);
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * @brief Finishes the queued tasks and joins the workers
+     */
+    ~ThreadPool();
+
+    /**
+     * @brief Gets the number of worker threads
+     * @return size_t - number of workers
+     */
+    size_t size() const { return workers.size(); }
+
+    /**
+     * @brief Gets the placement policy of the workers
+     * @return PinningPolicy - None if the workers float
+     */
+    PinningPolicy getPinning() const { return pinning; }
+
+    /**
+     * @brief Gets the cpu a worker is pinned to
+     * @param worker Index of the worker
+     * @return int - logical cpu number, -1 if the worker is not pinned
+     */
+    int getCpu(size_t worker) const { return worker < cpus.size() ? cpus[worker] : -1; }
+
+    /**
+     * @brief Queues a task for execution on one of the workers
+     * @tparam F Callable type taking no arguments
+     * @param task Callable to run
+     * @return future of the task's result, rethrows the task's exception on get()
+     */
+    template <typename F>
+    auto submit(F &&task) -> future<invoke_result_t<decay_t<F>>>;
+
+    /**
+     * @brief Queues a task for execution on one particular worker
+     *
+     * The task waits for that worker even if others are idle, so a job
+     * split into as many tasks as workers runs every part on a known (and,
+     * with pinning, fixed) core.
+     *
+     * @tparam F Callable type taking no arguments
+     * @param worker Index of the worker, taken modulo size()
+     * @param task Callable to run
+     * @return future of the task's result, rethrows the task's exception on get()
+     */
+    template <typename F>
+    auto submitTo(size_t worker, F &&task) -> future<invoke_result_t<decay_t<F>>>;
+
+    /**
+     * @brief Waits for every future, then rethrows the first exception among them
+     *
+     * Calling get() on each in turn would leave the caller's frame as soon
+     * as one task fails while the others still use it; here no task is
+     * running any more when the error reaches the caller.
+     *
+     * @param futures Futures of the tasks
+     */
+    static void waitAll(vector<future<void>> &futures);
+
+    /**
+     * @brief Chooses the cpus for pinned workers
+     *
+     * Compact takes the cpus node after node, Scatter takes one cpu from
+     * every node in turn. Only cpus the process is allowed to run on are
+     * used; with more workers than cpus the list wraps around.
+     *
+     * @param count Number of workers
+     * @param policy Placement policy
+     * @return vector<int> - cpu of every worker, empty for PinningPolicy::None
+     */
+    static vector<int> placeWorkers(size_t count, PinningPolicy policy);
+
+    /**
+     * @brief Gets the process-wide pool with one worker per hardware thread
+     * @return shared_ptr<ThreadPool> - created on first use
+     */
+    static shared_ptr<ThreadPool> shared();
+};
+
+ThreadPool::ThreadPool(size_t numThreads, PinningPolicy pinning)
+    : local(numThreads), stopping(false), pinning(pinning)
+{
+    if (numThreads == 0)
+    {
+        throw std::invalid_argument("Thread pool needs at least one thread");
+    }
+
+    cpus = placeWorkers(numThreads, pinning);
+    workers.reserve(numThreads);
+    for (size_t i = 0; i < numThreads; ++i)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::workerLoop(size_t id)
+{
+    if (id < cpus.size())
+    {
+        pinCurrentThread(cpus[id]);
+    }
+
+    queue<function<void()>> &own = local[id];
+    while (true)
+    {
+        function<void()> task;
+        {
+            unique_lock<mutex> lock(queueMutex);
+            taskAvailable.wait(lock, [this, &own]
+                               { return stopping || !own.empty() || !tasks.empty(); });
+            queue<function<void()>> &source = own.empty() ? tasks : own;
+            if (source.empty())
+            {
+                return; // stopping and nothing left to do
+            }
+            task = std::move(source.front());
+            source.pop();
+        }
+        task();
+    }
+}
+
+void ThreadPool::pinCurrentThread(int cpu)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set); // best effort, an unpinned worker still works
+#else
+    (void)cpu;
+#endif
+}
+
+vector<vector<int>> ThreadPool::numaNodes()
+{
+    vector<int> allowed;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &set))
+            {
+                allowed.push_back(cpu);
+            }
+        }
+    }
+#endif
+    if (allowed.empty())
+    {
+        for (unsigned cpu = 0; cpu < max(1u, thread::hardware_concurrency()); ++cpu)
+        {
+            allowed.push_back(static_cast<int>(cpu));
+        }
+    }
+
+    // every node lists its cpus as ranges, e.g. "0-7,16-23"
+    vector<vector<int>> nodes;
+    for (int node = 0;; ++node)
+    {
+        ifstream file("/sys/devices/system/node/node" + to_string(node) + "/cpulist");
+        string list;
+        if (!file || !getline(file, list))
+        {
+            break;
+        }
+
+        vector<int> members;
+        stringstream ranges(list);
+        string range;
+        while (getline(ranges, range, ','))
+        {
+            if (range.empty())
+            {
+                continue;
+            }
+            const size_t dash = range.find('-');
+            const int first = stoi(range.substr(0, dash));
+            const int last = dash == string::npos ? first : stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu)
+            {
+                if (find(allowed.begin(), allowed.end(), cpu) != allowed.end())
+                {
+                    members.push_back(cpu);
+                }
+            }
+        }
+        if (!members.empty())
+        {
+            nodes.push_back(std::move(members));
+        }
+    }
+
+    if (nodes.empty())
+    {
+        nodes.push_back(allowed);
+    }
+    return nodes;
+}
+
+vector<int> ThreadPool::placeWorkers(size_t count, PinningPolicy policy)
+{
+    if (policy == PinningPolicy::None)
+    {
+        return {};
+    }
+
+    const vector<vector<int>> nodes = numaNodes();
+    vector<int> order;
+    if (policy == PinningPolicy::Compact)
+    {
+        for (const auto &node : nodes)
+        {
+            order.insert(order.end(), node.begin(), node.end());
+        }
+    }
+    else
+    {
+        size_t longest = 0;
+        for (const auto &node : nodes)
+        {
+            longest = max(longest, node.size());
+        }
+        for (size_t k = 0; k < longest; ++k)
+        {
+            for (const auto &node : nodes)
+            {
+                if (k < node.size())
+                {
+                    order.push_back(node[k]);
+                }
+            }
+        }
+    }
+
+    vector<int> placement(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        placement[i] = order[i % order.size()];
+    }
+    return placement;
+}
+
+void ThreadPool::waitAll(vector<future<void>> &futures)
+{
+    exception_ptr first;
+    for (auto &f : futures)
+    {
+        try
+        {
+            f.get();
+        }
+        catch (...)
+        {
+            if (!first)
+            {
+                first = current_exception();
+            }
+        }
+    }
+    if (first)
+    {
+        rethrow_exception(first);
+    }
+}
+
+template <typename F>
+auto ThreadPool::submit(F &&task) -> future<invoke_result_t<decay_t<F>>>
+{
+    return enqueue(std::forward<F>(task), nullptr);
+}
+
+template <typename F>
+auto ThreadPool::submitTo(size_t worker, F &&task) -> future<invoke_result_t<decay_t<F>>>
+{
+    return enqueue(std::forward<F>(task), &local[worker % local.size()]);
+}
+
+template <typename F>
+auto ThreadPool::enqueue(F &&task, queue<function<void()>> *target) -> future<invoke_result_t<decay_t<F>>>
+{
+    using Result = invoke_result_t<decay_t<F>>;
+
+    // function<> needs a copyable callable, so the packaged_task is held by shared_ptr
+    auto packaged = make_shared<packaged_task<Result()>>(std::forward<F>(task));
+    future<Result> result = packaged->get_future();
+    {
+        lock_guard<mutex> lock(queueMutex);
+        if (stopping)
+        {
+            throw std::runtime_error("Cannot submit to a stopped thread pool");
+        }
+        (target ? *target : tasks).emplace([packaged]
+                                           { (*packaged)(); });
+    }
+    if (target)
+    {
+        taskAvailable.notify_all(); // the one worker that may take it has to be among the woken
+    }
+    else
+    {
+        taskAvailable.notify_one();
+    }
+    return result;
+}
+
+shared_ptr<ThreadPool> ThreadPool::shared()
+{
+    static shared_ptr<ThreadPool> pool =
+        make_shared<ThreadPool>(defaultSize());
+    return pool;
+}
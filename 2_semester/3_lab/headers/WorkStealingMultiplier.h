@@ -0,0 +1,291 @@
+#pragma once
+#include "MatrixMultiplier.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <stdexcept>
+
+/**
+ * @brief Busy and idle time of one worker during the last multiplication
+ */
+struct WorkerStats
+{
+    double busyMs = 0.0;    // time spent computing tiles
+    double idleMs = 0.0;    // time spent looking for work or waiting for the others
+    size_t tilesRun = 0;    // tiles computed by this worker
+    size_t tilesStolen = 0; // tiles taken from another worker's deque
+};
+
+/**
+ * @brief Parallel matrix multiplication with a work-stealing 2D tile scheduler
+ *
+ * The result matrix is cut into tileRows x tileCols tiles. The tiles are dealt
+ * round-robin into one deque per worker. A worker pops tiles from the back of
+ * its own deque; when it runs dry it steals from the front of another worker's
+ * deque, so a slow core or an uneven shape does not leave the others idle.
+ * Worker 0 is the calling thread, the others run on a private ThreadPool.
+ * With profiling enabled, per-worker busy/idle times are recorded and can be
+ * read with getStats() after multiply() returns.
+ */
+class WorkStealingMultiplier : public MatrixMultiplier
+{
+private:
+    /**
+     * @brief A rectangular block of the result matrix
+     */
+    struct Tile
+    {
+        size_t rowBegin, rowEnd;
+        size_t colBegin, colEnd;
+    };
+
+    /**
+     * @brief Per-worker queue of tiles, guarded by its own mutex
+     */
+    struct WorkerQueue
+    {
+        deque<Tile> tiles;
+        mutex lock;
+    };
+
+    size_t numThreads;           // number of workers, including the calling thread
+    unique_ptr<ThreadPool> pool; // numThreads - 1 helper threads, reused across calls
+    size_t tileRows;             // rows per tile
+    size_t tileCols;             // columns per tile
+    bool profiling;              // whether to record WorkerStats
+    vector<WorkerStats> stats;   // statistics of the last run
+
+    /**
+     * @brief Takes the next tile: own deque first, then steal from the others
+     * @param queues Deques of all workers
+     * @param self Index of the calling worker
+     * @param tile Output tile
+     * @param stolen Set to true if the tile came from another worker
+     * @return true if a tile was found, false if all deques are empty
+     */
+    static bool nextTile(vector<WorkerQueue> &queues, size_t self, Tile &tile, bool &stolen);
+
+    /**
+     * @brief Adds alpha times one tile of the product to the result
+     */
+    static void multiplyTile(const Matrix &a, const Matrix &b, Matrix &result, double alpha, const Tile &tile);
+
+    /**
+     * @brief Worker body: run tiles until no deque has any left
+     */
+    void workerLoop(const Matrix &a, const Matrix &b, Matrix &result, double alpha,
+                    vector<WorkerQueue> &queues, size_t self);
+
+protected:
+    /**
+     * @brief Multiplies two matrices into a caller-owned output, tiles are balanced between workers by stealing
+     * @param a First matrix
+     * @param b Second matrix
+     * @param out Receives (or accumulates) the product
+     * @param mode Overwrite out or add the product to it
+     * @param alpha Scale applied to the product
+     */
+    void compute(const Matrix &a, const Matrix &b, Matrix &out, Accumulate mode, double alpha) override;
+
+public:
+    /**
+     * @brief Construct a new Work Stealing Multiplier object
+     * @param numThreads Number of worker threads
+     * @param tileRows Rows per tile
+     * @param tileCols Columns per tile
+     * @param profiling Record per-worker busy/idle time
+     * @throw std::invalid_argument if any argument is zero
+     */
+    explicit WorkStealingMultiplier(size_t numThreads = ThreadPool::defaultSize(),
+                                    size_t tileRows = 64, size_t tileCols = 256,
+                                    bool profiling = false);
+
+    /**
+     * @brief Enables or disables per-worker time accounting
+     * @param enabled true to record WorkerStats on the next runs
+     */
+    void setProfiling(bool enabled) { profiling = enabled; }
+
+    /**
+     * @brief Gets the per-worker statistics of the last multiplication
+     * @return const vector<WorkerStats>& - empty if profiling was disabled
+     */
+    const vector<WorkerStats> &getStats() const { return stats; }
+
+    /**
+     * @brief Prints the per-worker statistics of the last multiplication
+     * @param os Output stream
+     */
+    void printStats(ostream &os) const;
+
+    /**
+     * @brief Gets the name of the multiplication algorithm
+     * @return const char* - "Work-stealing" as the algorithm identifier
+     */
+    const char *getName() const override { return "Work-stealing"; }
+};
+
+WorkStealingMultiplier::WorkStealingMultiplier(size_t numThreads, size_t tileRows,
+                                               size_t tileCols, bool profiling)
+    : numThreads(numThreads), tileRows(tileRows), tileCols(tileCols), profiling(profiling)
+{
+    if (numThreads == 0)
+    {
+        throw std::invalid_argument("Number of threads must be positive");
+    }
+    if (tileRows == 0 || tileCols == 0)
+    {
+        throw std::invalid_argument("Tile sizes must be positive");
+    }
+    if (numThreads > 1)
+    {
+        pool = make_unique<ThreadPool>(numThreads - 1);
+    }
+}
+
+bool WorkStealingMultiplier::nextTile(vector<WorkerQueue> &queues, size_t self, Tile &tile, bool &stolen)
+{
+    {
+        WorkerQueue &own = queues[self];
+        lock_guard<mutex> guard(own.lock);
+        if (!own.tiles.empty())
+        {
+            tile = own.tiles.back();
+            own.tiles.pop_back();
+            stolen = false;
+            return true;
+        }
+    }
+
+    // own deque is empty: try the others, starting with the next worker
+    for (size_t offset = 1; offset < queues.size(); ++offset)
+    {
+        WorkerQueue &victim = queues[(self + offset) % queues.size()];
+        lock_guard<mutex> guard(victim.lock);
+        if (!victim.tiles.empty())
+        {
+            tile = victim.tiles.front();
+            victim.tiles.pop_front();
+            stolen = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingMultiplier::multiplyTile(const Matrix &a, const Matrix &b, Matrix &result, double alpha,
+                                          const Tile &tile)
+{
+    const size_t inner = a.getCols();
+    for (size_t i = tile.rowBegin; i < tile.rowEnd; ++i)
+    {
+        const double *aRow = a.rowPtr(i);
+        double *cRow = result.rowPtr(i);
+        for (size_t k = 0; k < inner; ++k)
+        {
+            const double aik = alpha * aRow[k];
+            const double *bRow = b.rowPtr(k);
+            for (size_t j = tile.colBegin; j < tile.colEnd; ++j)
+            {
+                cRow[j] += aik * bRow[j];
+            }
+        }
+    }
+}
+
+void WorkStealingMultiplier::workerLoop(const Matrix &a, const Matrix &b, Matrix &result, double alpha,
+                                        vector<WorkerQueue> &queues, size_t self)
+{
+    WorkerStats local;
+    Tile tile;
+    bool stolen = false;
+    while (nextTile(queues, self, tile, stolen))
+    {
+        auto start = chrono::steady_clock::now();
+        multiplyTile(a, b, result, alpha, tile);
+        if (profiling)
+        {
+            local.busyMs += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        }
+        ++local.tilesRun;
+        local.tilesStolen += stolen ? 1 : 0;
+        finishTile();
+    }
+
+    if (profiling)
+    {
+        stats[self] = local;
+    }
+}
+
+void WorkStealingMultiplier::compute(const Matrix &a, const Matrix &b, Matrix &out, Accumulate mode,
+                                     double alpha)
+{
+    prepareOutput(a, b, out, mode);
+
+    const size_t n = a.getRows();
+    const size_t m = b.getCols();
+
+    // deal the tiles round-robin so every worker starts with a similar share
+    vector<WorkerQueue> queues(numThreads);
+    size_t next = 0;
+    size_t count = 0;
+    for (size_t i = 0; i < n; i += tileRows)
+    {
+        for (size_t j = 0; j < m; j += tileCols)
+        {
+            queues[next].tiles.push_back({i, min(i + tileRows, n), j, min(j + tileCols, m)});
+            next = (next + 1) % numThreads;
+            ++count;
+        }
+    }
+    startTiles(count);
+
+    stats.assign(profiling ? numThreads : 0, WorkerStats());
+
+    auto start = chrono::steady_clock::now();
+    vector<future<void>> workers;
+    for (size_t t = 1; t < numThreads; ++t)
+    {
+        workers.push_back(pool->submit([this, alpha, &a, &b, &out, &queues, t]
+                                       { workerLoop(a, b, out, alpha, queues, t); }));
+    }
+    // the calling thread is worker 0; if it stops early the others must still finish with the queues
+    exception_ptr failure;
+    try
+    {
+        workerLoop(a, b, out, alpha, queues, 0);
+    }
+    catch (...)
+    {
+        failure = current_exception();
+    }
+    ThreadPool::waitAll(workers);
+    if (failure)
+    {
+        rethrow_exception(failure);
+    }
+
+    // everything that is not computing - searching, stealing, waiting for the last tile - is idle
+    if (profiling)
+    {
+        double total = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        for (auto &s : stats)
+        {
+            s.idleMs = max(0.0, total - s.busyMs);
+        }
+    }
+}
+
+void WorkStealingMultiplier::printStats(ostream &os) const
+{
+    for (size_t t = 0; t < stats.size(); ++t)
+    {
+        os << "  worker " << t << ": busy " << fixed << setprecision(2) << stats[t].busyMs
+           << " ms, idle " << stats[t].idleMs << " ms, tiles " << stats[t].tilesRun
+           << " (" << stats[t].tilesStolen << " stolen)\n";
+    }
+}
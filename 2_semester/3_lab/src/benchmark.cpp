@@ -0,0 +1,733 @@
+/**
+ * @file benchmark.cpp
+ * @author Valeria
+ * @brief Non-interactive benchmark driver for the matrix multipliers
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Sweeps matrix shapes, thread counts and multiplication strategies, runs
+ * warm-ups and repetitions for every combination and reports min, median and
+ * p95 latency together with GFLOP/s. Results can be written as CSV and JSON.
+ * With --counters the hardware performance counters of every run are
+ * averaged and reported next to the timings, broken down per strip for the
+ * parallel multiplier and per part for the K-split one. With --verify every product of the last repetition is
+ * checked with Freivalds' O(n^2) test, and the exit code reports a failure.
+ *
+ * Example:
+ *   benchmark --sizes 256,512,1000 --shapes 8x100000x8 --threads 1,2,4
+ *             --strategies sequential,parallel,simd --reps 5 --csv out.csv
+ */
+
+#include "../headers/SequentialMultiplier.h"
+#include "../headers/ParallelMultiplier.h"
+#include "../headers/KSplitMultiplier.h"
+#include "../headers/BlockedMultiplier.h"
+#include "../headers/SimdMultiplier.h"
+#include "../headers/WorkStealingMultiplier.h"
+#include "../headers/StrassenMultiplier.h"
+#include "../headers/OutOfCoreMultiplier.h"
+#include "../headers/FixedSizeMultiplier.h"
+#include "../headers/AutoMultiplier.h"
+#include "../headers/Freivalds.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Dimensions of one product: (rows x inner) * (inner x cols)
+ */
+struct Shape
+{
+    size_t rows;
+    size_t inner;
+    size_t cols;
+};
+
+/**
+ * @brief Settings parsed from the command line
+ */
+struct BenchmarkConfig
+{
+    vector<Shape> shapes;
+    vector<size_t> threads = {ThreadPool::defaultSize()};
+    vector<string> strategies = {"sequential", "parallel", "blocked", "simd"};
+    size_t warmups = 1;
+    size_t repetitions = 5;
+    string csvPath;
+    string jsonPath;
+    string tuningPath;
+    bool counters = false; // collect hardware performance counters
+    size_t verifyRounds = 0; // Freivalds rounds per result, 0 to skip the check
+};
+
+/**
+ * @brief Timing summary of one (shape, strategy, threads) combination
+ */
+struct BenchmarkResult
+{
+    Shape shape;
+    string strategy; // name reported by the multiplier
+    size_t threads;
+    double minMs;
+    double medianMs;
+    double p95Ms;
+    double gflops; // computed from the median
+    PerfSample counters; // mean per run, empty unless --counters
+    vector<PerfSample> stripCounters; // per strip (or K-split part) of the last run, parallel and K-split only
+    VerifyResult verification{true, 0.0, 0}; // check of the last result, no rounds without --verify
+    string error; // message if the combination threw instead of finishing, empty otherwise
+};
+
+/**
+ * @brief Splits a comma-separated list
+ *
+ * @param text List such as "1,2,4"
+ * @return vector<string> - the items, without empty ones
+ */
+vector<string> splitList(const string &text)
+{
+    vector<string> items;
+    stringstream ss(text);
+    string item;
+    while (getline(ss, item, ','))
+    {
+        if (!item.empty())
+        {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+/**
+ * @brief Parses a non-negative integer argument
+ *
+ * @param text Argument text
+ * @param minimum Smallest accepted value, 1 for counts that must be positive
+ * @return size_t - parsed value
+ * @throw std::invalid_argument if the text is not an integer of at least minimum
+ */
+size_t parseCount(const string &text, size_t minimum = 1)
+{
+    // stoull would accept a sign and wrap "-1" around to 2^64 - 1
+    if (text.empty() || !isdigit(static_cast<unsigned char>(text[0])))
+    {
+        throw std::invalid_argument("Expected a non-negative integer, got '" + text + "'");
+    }
+    size_t pos = 0;
+    unsigned long long value = 0;
+    try
+    {
+        value = stoull(text, &pos);
+    }
+    catch (const std::out_of_range &)
+    {
+        throw std::invalid_argument("Number out of range: '" + text + "'");
+    }
+    if (pos != text.size() || value < minimum)
+    {
+        throw std::invalid_argument("Expected an integer of at least " + to_string(minimum) + ", got '" + text + "'");
+    }
+    return static_cast<size_t>(value);
+}
+
+/**
+ * @brief Quotes a text for a CSV field, doubling the quotes inside
+ */
+string csvQuote(const string &text)
+{
+    string quoted = "\"";
+    for (char ch : text)
+    {
+        quoted += ch == '"' ? string("\"\"") : string(1, ch);
+    }
+    return quoted + "\"";
+}
+
+/**
+ * @brief Quotes a text as a JSON string
+ */
+string jsonQuote(const string &text)
+{
+    string quoted = "\"";
+    for (char ch : text)
+    {
+        if (ch == '"' || ch == '\\')
+        {
+            quoted += '\\';
+            quoted += ch;
+        }
+        else if (static_cast<unsigned char>(ch) < 0x20)
+        {
+            quoted += ' ';
+        }
+        else
+        {
+            quoted += ch;
+        }
+    }
+    return quoted + "\"";
+}
+
+/**
+ * @brief Parses a shape written as "MxKxN"
+ *
+ * @param text Shape text
+ * @return Shape - parsed dimensions
+ * @throw std::invalid_argument if the text is not three positive integers separated by 'x'
+ */
+Shape parseShape(const string &text)
+{
+    vector<string> parts;
+    stringstream ss(text);
+    string part;
+    while (getline(ss, part, 'x'))
+    {
+        parts.push_back(part);
+    }
+    if (parts.size() != 3)
+    {
+        throw std::invalid_argument("Shape must look like MxKxN, got '" + text + "'");
+    }
+    return {parseCount(parts[0]), parseCount(parts[1]), parseCount(parts[2])};
+}
+
+/**
+ * @brief Checks whether a strategy uses the thread count
+ *
+ * @param strategy Strategy identifier
+ * @return true if the thread sweep applies to it
+ */
+bool isThreaded(const string &strategy)
+{
+    return strategy == "parallel" || strategy == "parallel-packed" || strategy == "parallel-compact" ||
+           strategy == "parallel-scatter" || strategy == "k-split" || strategy == "work-stealing" ||
+           strategy == "auto";
+}
+
+/**
+ * @brief Creates a multiplier from its command-line identifier
+ *
+ * @param strategy Strategy identifier
+ * @param threads Number of threads for the parallel strategies
+ * @param tuningPath Tuning table of the auto strategy, empty to keep it in memory
+ * @return unique_ptr<MatrixMultiplier> - the multiplier
+ * @throw std::invalid_argument for an unknown identifier
+ */
+unique_ptr<MatrixMultiplier> makeMultiplier(const string &strategy, size_t threads, const string &tuningPath = "")
+{
+    if (strategy == "sequential")
+        return make_unique<SequentialMultiplier>();
+    if (strategy == "sequential-packed")
+        return make_unique<SequentialMultiplier>(true);
+    if (strategy == "parallel")
+        return make_unique<ParallelMultiplier>(threads);
+    if (strategy == "parallel-packed")
+        return make_unique<ParallelMultiplier>(threads, true);
+    if (strategy == "parallel-compact")
+        return make_unique<ParallelMultiplier>(threads, true, PinningPolicy::Compact);
+    if (strategy == "parallel-scatter")
+        return make_unique<ParallelMultiplier>(threads, true, PinningPolicy::Scatter);
+    if (strategy == "k-split")
+        return make_unique<KSplitMultiplier>(threads);
+    if (strategy == "blocked")
+        return make_unique<BlockedMultiplier>();
+    if (strategy == "simd")
+        return make_unique<SimdMultiplier>();
+    if (strategy == "strassen")
+        return make_unique<StrassenMultiplier>();
+    if (strategy == "work-stealing")
+        return make_unique<WorkStealingMultiplier>(threads);
+    if (strategy == "out-of-core")
+        return make_unique<OutOfCoreMultiplier>();
+    if (strategy == "fixed-size")
+        return make_unique<FixedSizeMultiplier>();
+    if (strategy == "auto")
+        return make_unique<AutoMultiplier>(tuningPath, threads);
+    throw std::invalid_argument("Unknown strategy '" + strategy + "'");
+}
+
+/**
+ * @brief Prints the command-line help
+ */
+void printUsage()
+{
+    cout << "Usage: benchmark [options]\n"
+         << "  --sizes N,N,...         square sizes (N x N times N x N)\n"
+         << "  --shapes MxKxN,...      rectangular products (M x K times K x N)\n"
+         << "  --threads T,T,...       thread counts for the parallel strategies\n"
+         << "  --strategies S,S,...    sequential, sequential-packed, parallel, parallel-packed,\n"
+         << "                          parallel-compact, parallel-scatter, k-split, blocked, simd,\n"
+         << "                          strassen, work-stealing, out-of-core, fixed-size, auto\n"
+         << "  --warmup N              untimed runs before measuring (default 1)\n"
+         << "  --reps N                timed runs per combination (default 5)\n"
+         << "  --csv FILE              write results as CSV\n"
+         << "  --json FILE             write results as JSON\n"
+         << "  --tuning FILE           tuning table of the auto strategy, reused across runs\n"
+         << "  --counters              report hardware performance counters (Linux perf_event_open)\n"
+         << "  --verify N              check every result with N rounds of Freivalds' test\n";
+}
+
+/**
+ * @brief Parses the command line
+ *
+ * @param argc Argument count
+ * @param argv Arguments
+ * @return BenchmarkConfig - parsed settings
+ * @throw std::invalid_argument on malformed arguments
+ */
+BenchmarkConfig parseArguments(int argc, char *argv[])
+{
+    BenchmarkConfig config;
+    for (int i = 1; i < argc; ++i)
+    {
+        string option = argv[i];
+        if (option == "--help" || option == "-h")
+        {
+            printUsage();
+            exit(0);
+        }
+        if (option == "--counters")
+        {
+            config.counters = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            throw std::invalid_argument("Missing value for " + option);
+        }
+        string value = argv[++i];
+
+        if (option == "--sizes")
+        {
+            for (const auto &item : splitList(value))
+            {
+                size_t n = parseCount(item);
+                config.shapes.push_back({n, n, n});
+            }
+        }
+        else if (option == "--shapes")
+        {
+            for (const auto &item : splitList(value))
+            {
+                config.shapes.push_back(parseShape(item));
+            }
+        }
+        else if (option == "--threads")
+        {
+            config.threads.clear();
+            for (const auto &item : splitList(value))
+            {
+                config.threads.push_back(parseCount(item));
+            }
+        }
+        else if (option == "--strategies")
+        {
+            config.strategies = splitList(value);
+        }
+        else if (option == "--warmup")
+        {
+            config.warmups = parseCount(value, 0);
+        }
+        else if (option == "--reps")
+        {
+            config.repetitions = parseCount(value);
+        }
+        else if (option == "--csv")
+        {
+            config.csvPath = value;
+        }
+        else if (option == "--json")
+        {
+            config.jsonPath = value;
+        }
+        else if (option == "--tuning")
+        {
+            config.tuningPath = value;
+        }
+        else if (option == "--verify")
+        {
+            config.verifyRounds = parseCount(value);
+        }
+        else
+        {
+            throw std::invalid_argument("Unknown option " + option);
+        }
+    }
+
+    if (config.shapes.empty())
+    {
+        config.shapes = {{256, 256, 256}, {512, 512, 512}};
+    }
+    if (config.threads.empty() || config.strategies.empty())
+    {
+        throw std::invalid_argument("Thread and strategy lists must not be empty");
+    }
+    return config;
+}
+
+/**
+ * @brief Gets the value below which the given fraction of sorted samples lie
+ *
+ * @param sorted Samples in ascending order
+ * @param fraction Quantile in [0, 1]
+ * @return double - nearest-rank quantile
+ */
+double quantile(const vector<double> &sorted, double fraction)
+{
+    size_t rank = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[min(rank, sorted.size() - 1)];
+}
+
+/**
+ * @brief Enables the per-worker counters of the multipliers that have them
+ * @param multiplier The multiplication algorithm to configure
+ * @param enabled true to measure every strip or part of the next calls
+ */
+void setWorkerCounting(MatrixMultiplier &multiplier, bool enabled)
+{
+    if (auto *parallel = dynamic_cast<ParallelMultiplier *>(&multiplier))
+    {
+        parallel->setCounting(enabled);
+    }
+    else if (auto *kSplit = dynamic_cast<KSplitMultiplier *>(&multiplier))
+    {
+        kSplit->setCounting(enabled);
+    }
+}
+
+/**
+ * @brief Gets the per-worker counters of the last call
+ * @param multiplier The multiplication algorithm that ran
+ * @return vector<PerfSample> - one entry per strip of the parallel multiplier or part
+ * of the K-split multiplier, empty for the other strategies
+ */
+vector<PerfSample> workerCounters(const MatrixMultiplier &multiplier)
+{
+    if (auto *parallel = dynamic_cast<const ParallelMultiplier *>(&multiplier))
+    {
+        return parallel->getStripCounters();
+    }
+    if (auto *kSplit = dynamic_cast<const KSplitMultiplier *>(&multiplier))
+    {
+        return kSplit->getPartCounters();
+    }
+    return {};
+}
+
+/**
+ * @brief Times one multiplier on one pair of matrices
+ *
+ * @param a First input matrix
+ * @param b Second input matrix
+ * @param multiplier The multiplication algorithm to use
+ * @param config Warm-up and repetition counts
+ * @param counters If not null, receives the mean hardware counters of a run
+ * @param last If not null, receives the result of the last timed run
+ * @return vector<double> - sorted run times in milliseconds
+ */
+vector<double> measure(const Matrix &a, const Matrix &b, MatrixMultiplier &multiplier,
+                       const BenchmarkConfig &config, PerfSample *counters = nullptr, Matrix *last = nullptr)
+{
+    // the counters follow the calling thread; strips and K-split parts report their workers' own
+    setWorkerCounting(multiplier, counters != nullptr);
+
+    for (size_t i = 0; i < config.warmups; ++i)
+    {
+        multiplier.multiply(a, b);
+    }
+
+    vector<double> samples;
+    PerfSample total;
+    for (size_t i = 0; i < config.repetitions; ++i)
+    {
+        const PerfSample before = counters ? PerfCounters::forThisThread().read() : PerfSample();
+        auto start = chrono::steady_clock::now();
+        Matrix result = multiplier.multiply(a, b);
+        auto end = chrono::steady_clock::now();
+        samples.push_back(chrono::duration<double, milli>(end - start).count());
+        if (last)
+        {
+            *last = std::move(result);
+        }
+
+        if (counters)
+        {
+            total += PerfCounters::forThisThread().read() - before;
+            for (const auto &strip : workerCounters(multiplier))
+            {
+                total += strip;
+            }
+        }
+    }
+    if (counters)
+    {
+        *counters = total /= config.repetitions;
+    }
+    sort(samples.begin(), samples.end());
+    return samples;
+}
+
+/**
+ * @brief Writes the results as CSV
+ *
+ * @param path Output file
+ * @param results Benchmark results
+ * @param counters Add a column per hardware counter, empty where it was unavailable
+ * @param verify Add the verification outcome and residual
+ *
+ * The last column holds the error of a combination that threw; its timing,
+ * counter and verification fields are left empty.
+ */
+void writeCsv(const string &path, const vector<BenchmarkResult> &results, bool counters, bool verify)
+{
+    ofstream out(path);
+    if (!out)
+    {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    out << "rows,inner,cols,strategy,threads,min_ms,median_ms,p95_ms,gflops";
+    for (int e = 0; counters && e < PERF_EVENT_COUNT; ++e)
+    {
+        out << ',' << PerfSample::eventName(e);
+    }
+    if (verify)
+    {
+        out << ",verified,residual";
+    }
+    out << ",error\n";
+    for (const auto &r : results)
+    {
+        const bool ran = r.error.empty();
+        out << r.shape.rows << ',' << r.shape.inner << ',' << r.shape.cols << ','
+            << csvQuote(r.strategy) << ',' << r.threads;
+        if (ran)
+        {
+            out << ',' << r.minMs << ',' << r.medianMs << ',' << r.p95Ms << ',' << r.gflops;
+        }
+        else
+        {
+            out << ",,,,";
+        }
+        for (int e = 0; counters && e < PERF_EVENT_COUNT; ++e)
+        {
+            out << ',';
+            if (r.counters.present[e])
+            {
+                out << r.counters.values[e];
+            }
+        }
+        if (verify && ran)
+        {
+            out << ',' << (r.verification.passed ? "true" : "false") << ',' << r.verification.maxResidual;
+        }
+        else if (verify)
+        {
+            out << ",,";
+        }
+        out << ',' << (ran ? "" : csvQuote(r.error)) << '\n';
+    }
+}
+
+/**
+ * @brief Writes the results as a JSON array
+ *
+ * @param path Output file
+ * @param results Benchmark results
+ * @param counters Add the hardware counters, null where they were unavailable
+ * @param verify Add the verification outcome and residual
+ *
+ * A combination that threw has null timings and its message under "error".
+ */
+void writeJson(const string &path, const vector<BenchmarkResult> &results, bool counters, bool verify)
+{
+    ofstream out(path);
+    if (!out)
+    {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const auto &r = results[i];
+        const bool ran = r.error.empty();
+        out << "  {\"rows\": " << r.shape.rows << ", \"inner\": " << r.shape.inner
+            << ", \"cols\": " << r.shape.cols << ", \"strategy\": " << jsonQuote(r.strategy)
+            << ", \"threads\": " << r.threads;
+        if (ran)
+        {
+            out << ", \"min_ms\": " << r.minMs << ", \"median_ms\": " << r.medianMs
+                << ", \"p95_ms\": " << r.p95Ms << ", \"gflops\": " << r.gflops;
+        }
+        else
+        {
+            out << ", \"min_ms\": null, \"median_ms\": null, \"p95_ms\": null, \"gflops\": null";
+        }
+        for (int e = 0; counters && e < PERF_EVENT_COUNT; ++e)
+        {
+            out << ", \"" << PerfSample::eventName(e) << "\": ";
+            if (r.counters.present[e])
+            {
+                out << r.counters.values[e];
+            }
+            else
+            {
+                out << "null";
+            }
+        }
+        if (verify && ran)
+        {
+            out << ", \"verified\": " << (r.verification.passed ? "true" : "false")
+                << ", \"residual\": " << r.verification.maxResidual;
+        }
+        else if (verify)
+        {
+            out << ", \"verified\": null, \"residual\": null";
+        }
+        out << ", \"error\": " << (ran ? "null" : jsonQuote(r.error)) << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+/**
+ * @brief Main program entry point
+ *
+ * @param argc Argument count
+ * @param argv Arguments, see printUsage()
+ * @return int Exit code (0 for success, 1 for invalid arguments, 2 if a combination threw or failed --verify)
+ */
+int main(int argc, char *argv[])
+{
+    BenchmarkConfig config;
+    try
+    {
+        config = parseArguments(argc, argv);
+        for (const auto &strategy : config.strategies)
+        {
+            makeMultiplier(strategy, 1); // reject unknown names before running anything
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n\n";
+        printUsage();
+        return 1;
+    }
+
+    if (config.counters && !PerfCounters::forThisThread().isAvailable())
+    {
+        cout << "Hardware counters are unavailable (perf_event_open failed), reporting timings only\n";
+        config.counters = false;
+    }
+
+    vector<BenchmarkResult> results;
+    bool allVerified = true;
+    bool allRan = true;
+    cout << left << setw(18) << "shape" << setw(28) << "strategy" << setw(8) << "threads"
+         << setw(12) << "min ms" << setw(12) << "median ms" << setw(12) << "p95 ms"
+         << "GFLOP/s\n";
+
+    for (const auto &shape : config.shapes)
+    {
+        Matrix a(shape.rows, shape.inner);
+        Matrix b(shape.inner, shape.cols);
+        a.randomize(1); // fixed seeds, so every run measures the same inputs
+        b.randomize(2);
+        const double flops = 2.0 * shape.rows * shape.inner * shape.cols;
+
+        for (const auto &strategy : config.strategies)
+        {
+            vector<size_t> threadCounts = isThreaded(strategy) ? config.threads : vector<size_t>{1};
+            for (size_t threads : threadCounts)
+            {
+                string shapeText = to_string(shape.rows) + "x" + to_string(shape.inner) + "x" + to_string(shape.cols);
+                BenchmarkResult r{shape, strategy, threads, 0.0, 0.0, 0.0, 0.0, {}, {}, {true, 0.0, 0}, ""};
+
+                // a failing combination (out of memory, a file error, ...) is reported and the sweep goes on
+                try
+                {
+                    auto multiplier = makeMultiplier(strategy, threads, config.tuningPath);
+                    PerfSample counters;
+                    Matrix last(0, 0);
+                    vector<double> samples = measure(a, b, *multiplier, config,
+                                                     config.counters ? &counters : nullptr,
+                                                     config.verifyRounds ? &last : nullptr);
+
+                    r.strategy = multiplier->getName();
+                    r.minMs = samples.front();
+                    r.medianMs = quantile(samples, 0.5);
+                    r.p95Ms = quantile(samples, 0.95);
+                    r.gflops = flops / (r.medianMs * 1e6);
+                    r.counters = counters;
+                    r.stripCounters = workerCounters(*multiplier);
+                    if (config.verifyRounds)
+                    {
+                        r.verification = verifyProduct(a, b, last, config.verifyRounds);
+                        allVerified = allVerified && r.verification.passed;
+                    }
+                }
+                catch (const exception &e)
+                {
+                    r.error = e.what();
+                    r.counters = PerfSample();
+                    r.stripCounters.clear();
+                    allRan = false;
+                }
+                results.push_back(r);
+
+                if (!r.error.empty())
+                {
+                    cout << left << setw(18) << shapeText << setw(28) << r.strategy << setw(8) << r.threads
+                         << "error: " << r.error << "\n";
+                    continue;
+                }
+                cout << left << setw(18) << shapeText << setw(28) << r.strategy << setw(8) << r.threads
+                     << fixed << setprecision(2) << setw(12) << r.minMs << setw(12) << r.medianMs
+                     << setw(12) << r.p95Ms << r.gflops << "\n";
+                if (config.counters)
+                {
+                    cout << "    " << r.counters << "\n";
+                    for (size_t i = 0; i < r.stripCounters.size(); ++i)
+                    {
+                        cout << "      strip " << i << ": " << r.stripCounters[i] << "\n";
+                    }
+                }
+                if (config.verifyRounds)
+                {
+                    cout << "    verify: " << (r.verification.passed ? "passed" : "FAILED") << " after "
+                         << r.verification.rounds << " rounds, max residual " << scientific << setprecision(2)
+                         << r.verification.maxResidual << "\n";
+                }
+            }
+        }
+    }
+
+    if (!config.csvPath.empty())
+    {
+        writeCsv(config.csvPath, results, config.counters, config.verifyRounds > 0);
+    }
+    if (!config.jsonPath.empty())
+    {
+        writeJson(config.jsonPath, results, config.counters, config.verifyRounds > 0);
+    }
+    if (!allRan)
+    {
+        cerr << "Some combinations failed with an error\n";
+    }
+    if (!allVerified)
+    {
+        cerr << "Some results failed verification\n";
+    }
+    if (!allRan || !allVerified)
+    {
+        return 2;
+    }
+    return 0;
+}
@@ -6,13 +6,18 @@
  *
  * @copyright Copyright (c) 2025
  *
- * This program demonstrates and compares the performance of sequential
- * and parallel matrix multiplication algorithms. It allows users to
- * specify matrix sizes and the number of threads for parallel computation.
+ * This program demonstrates and compares the performance of sequential,
+ * cache-blocked, SIMD, Strassen-Winograd, parallel and work-stealing
+ * matrix multiplication algorithms. It allows users to specify matrix
+ * sizes and the number of threads for parallel computation.
  */
 
 #include "../headers/SequentialMultiplier.h"
 #include "../headers/ParallelMultiplier.h"
+#include "../headers/BlockedMultiplier.h"
+#include "../headers/SimdMultiplier.h"
+#include "../headers/WorkStealingMultiplier.h"
+#include "../headers/StrassenMultiplier.h"
 #include <chrono>
 #include <iomanip>
 #include <memory>
@@ -42,22 +47,48 @@ void printMatrixOperation(const Matrix &a, const Matrix &b, const Matrix &result
 /**
  * @brief Performs matrix multiplication and measures execution time
  *
+ * Where Linux perf_event_open is available, the hardware counters of the
+ * run are printed under the timing, per strip for the parallel multiplier.
+ *
  * @param a First input matrix
  * @param b Second input matrix
  * @param multiplier The multiplication algorithm to use
  */
 void runTest(const Matrix &a, const Matrix &b, MatrixMultiplier &multiplier)
 {
+    PerfCounters &counters = PerfCounters::forThisThread();
+    auto *parallel = dynamic_cast<ParallelMultiplier *>(&multiplier);
+    if (parallel)
+    {
+        parallel->setCounting(counters.isAvailable());
+    }
+    const PerfSample before = counters.read();
     auto start = chrono::high_resolution_clock::now();
 
     Matrix result = multiplier.multiply(a, b);
 
     auto end = chrono::high_resolution_clock::now();
     auto duration = chrono::duration_cast<chrono::milliseconds>(end - start);
+    const PerfSample after = counters.read();
 
     cout << multiplier.getName() << " Multiplication took: "
          << duration.count() << " ms\n";
 
+    if (counters.isAvailable())
+    {
+        const vector<PerfSample> strips = parallel ? parallel->getStripCounters() : vector<PerfSample>();
+        PerfSample total = after - before;
+        for (const auto &strip : strips)
+        {
+            total += strip;
+        }
+        cout << "  counters: " << total << "\n";
+        for (size_t i = 0; i < strips.size(); ++i)
+        {
+            cout << "    thread " << i << ": " << strips[i] << "\n";
+        }
+    }
+
     // print matrices if they're not too big
     if (a.getRows() <= MAX_PRINT && a.getCols() <= MAX_PRINT &&
         b.getRows() <= MAX_PRINT && b.getCols() <= MAX_PRINT)
@@ -105,7 +136,7 @@ T getInput(const string &prompt, T min_val, T max_val)
 int main()
 {
     // get available CPU threads
-    size_t max_threads = thread::hardware_concurrency();
+    size_t max_threads = ThreadPool::defaultSize(); // at least 1, also when the count is unknown
     cout << "Your CPU has " << max_threads << " available threads.\n\n";
 
     // get matrix size from user
@@ -129,19 +160,45 @@ int main()
     Matrix a(size, size);
     Matrix b(size, size);
 
+    if (!PerfCounters::forThisThread().isAvailable())
+    {
+        cout << "Hardware counters are unavailable, reporting timings only.\n";
+    }
+
     cout << "Initializing matrices...\n";
     a.randomize();
     b.randomize();
 
     // multipliers
     SequentialMultiplier seqMult;
+    SequentialMultiplier packedSeqMult(true);
     ParallelMultiplier parMult(numThreads);
+    BlockedMultiplier blockedMult;
+    SimdMultiplier simdMult;
+    StrassenMultiplier strassenMult;
+    WorkStealingMultiplier wsMult(numThreads, 64, 256, true);
 
     cout << "\nRunning sequential multiplication...\n";
     runTest(a, b, seqMult);
 
+    cout << "\nRunning packed sequential multiplication...\n";
+    runTest(a, b, packedSeqMult);
+
+    cout << "\nRunning blocked multiplication...\n";
+    runTest(a, b, blockedMult);
+
+    cout << "\nRunning SIMD multiplication...\n";
+    runTest(a, b, simdMult);
+
+    cout << "\nRunning Strassen-Winograd multiplication...\n";
+    runTest(a, b, strassenMult);
+
     cout << "\nRunning parallel multiplication...\n";
     runTest(a, b, parMult);
 
+    cout << "\nRunning work-stealing multiplication...\n";
+    runTest(a, b, wsMult);
+    wsMult.printStats(cout);
+
     return 0;
 }
\ No newline at end of file